@@ -32,6 +32,7 @@ public class BVHImporter : ModuleRules
 		PrivateDependencyModuleNames.AddRange(
 			new string[]
 			{
+				"BVHRuntime",
 				"CoreUObject",
 				"Engine",
 				"Slate",
@@ -43,6 +44,9 @@ public class BVHImporter : ModuleRules
 				"SkeletalMeshDescription",
 				"MeshUtilities",
 				"AssetRegistry",
+				"AssetTools",
+				"DerivedDataCache",
+				"DeveloperSettings",
 				"AnimationBlueprintLibrary"
 			}
 			);
@@ -0,0 +1,471 @@
+#include "BVHImporterLog.h"
+#include "BVHParser.h"
+#include "BVHTokenizer.h"
+#include "BVHTrackConversion.h"
+#include "BVHTrackConverter.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/StringBuilder.h"
+
+namespace
+{
+	// Best of a few runs, the first one pays for page faults and cold caches
+	template <typename FuncType>
+	double MeasureBest(FuncType&& Func, int32 NumRuns = 3)
+	{
+		double Best = MAX_dbl;
+		for (int32 Run = 0; Run < NumRuns; ++Run)
+		{
+			const double Start = FPlatformTime::Seconds();
+			Func();
+			Best = FMath::Min(Best, FPlatformTime::Seconds() - Start);
+		}
+		return Best;
+	}
+
+	// Motion values in the shapes exporters write: mostly fixed six-decimal angles and positions,
+	// with a few short and exponent forms mixed in
+	TArray<ANSICHAR> MakeMotionText(int32 NumValues)
+	{
+		static const ANSICHAR* Formats[] = { "%.6f ", "%.6f ", "%.6f ", "%.4f ", "%.2f ", "%g " };
+
+		FRandomStream Random(0x42564821);
+		TArray<ANSICHAR> Text;
+		Text.Reserve((int64)NumValues * 12);
+		for (int32 Index = 0; Index < NumValues; ++Index)
+		{
+			ANSICHAR Buffer[64];
+			const double Value = Random.FRandRange(-180.0f, 180.0f) * (Index % 17 == 0 ? 1e-4 : 1.0);
+			const int32 Len = FCStringAnsi::Snprintf(Buffer, UE_ARRAY_COUNT(Buffer), Formats[Index % UE_ARRAY_COUNT(Formats)], Value);
+			Text.Append(Buffer, Len);
+		}
+		return Text;
+	}
+
+	void BenchmarkFloatParse(const TArray<FString>& Args)
+	{
+		const int32 NumValues = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 4000000;
+		const TArray<ANSICHAR> Text = MakeMotionText(NumValues);
+
+		// Tokenize up front so both runs time only the numeric conversion
+		TArray<FAnsiStringView> Tokens;
+		Tokens.Reserve(NumValues);
+		FBVHTokenizer Tokenizer(Text.GetData(), Text.GetData() + Text.Num());
+		FAnsiStringView Token;
+		while (Tokenizer.NextToken(Token))
+		{
+			Tokens.Add(Token);
+		}
+
+		TArray<double> AtodValues;
+		TArray<double> FastValues;
+		AtodValues.SetNumUninitialized(Tokens.Num());
+		FastValues.SetNumUninitialized(Tokens.Num());
+
+		auto Measure = [&Tokens](TArray<double>& OutValues, double (*Convert)(FAnsiStringView))
+		{
+			return MeasureBest([&Tokens, &OutValues, Convert]()
+			{
+				for (int32 Index = 0; Index < Tokens.Num(); ++Index)
+				{
+					OutValues[Index] = Convert(Tokens[Index]);
+				}
+			});
+		};
+
+		const double AtodSeconds = Measure(AtodValues, &FBVHTokenizer::ToDoubleAtod);
+		const double FastSeconds = Measure(FastValues, &FBVHTokenizer::ToDouble);
+
+		int32 NumMismatches = 0;
+		int32 NumFastPath = 0;
+		for (int32 Index = 0; Index < Tokens.Num(); ++Index)
+		{
+			NumMismatches += FMemory::Memcmp(&AtodValues[Index], &FastValues[Index], sizeof(double)) != 0;
+			double Value;
+			NumFastPath += BVHFastFloat::TryParse(Tokens[Index].GetData(), Tokens[Index].GetData() + Tokens[Index].Len(), Value);
+		}
+
+		const double Gigabytes = Text.Num() / 1e9;
+		UE_LOG(LogBVHImporter, Display, TEXT("BVH.BenchmarkFloatParse: %d values, %.1f MB of motion text"), Tokens.Num(), Text.Num() / 1e6);
+		UE_LOG(LogBVHImporter, Display, TEXT("  Atod: %.3f GB/s (%.1f ms)"), Gigabytes / AtodSeconds, AtodSeconds * 1000.0);
+		UE_LOG(LogBVHImporter, Display, TEXT("  Fast: %.3f GB/s (%.1f ms), %.1fx, %.2f%% on the fast path"), Gigabytes / FastSeconds, FastSeconds * 1000.0, AtodSeconds / FastSeconds, 100.0 * NumFastPath / FMath::Max(Tokens.Num(), 1));
+		if (NumMismatches > 0)
+		{
+			UE_LOG(LogBVHImporter, Error, TEXT("  %d values differ from Atod"), NumMismatches);
+		}
+	}
+
+	FAutoConsoleCommand BenchmarkFloatParseCommand(
+		TEXT("BVH.BenchmarkFloatParse"),
+		TEXT("Measures motion value parsing throughput of the fast float path against Atod. Usage: BVH.BenchmarkFloatParse [NumValues]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkFloatParse));
+
+	// Rig shaped like a capture skeleton: a six channel root with chains of joints hanging off it, each chain
+	// ending in an end site. Rotation orders cycle through the specialized samplers, every seventh joint has
+	// only two rotation channels so the custom path is exercised as well.
+	void MakeSyntheticBVH(int32 NumJoints, int32 NumFrames, FAnsiStringBuilderBase& Text)
+	{
+		static const ANSICHAR* RotationOrders[] = { "Zrotation Xrotation Yrotation", "Xrotation Yrotation Zrotation", "Yrotation Xrotation Zrotation", "Zrotation Yrotation Xrotation" };
+		constexpr int32 ChainLength = 4;
+
+		Text << "HIERARCHY\nROOT Hips\n{\n\tOFFSET 0.000000 90.000000 0.000000\n";
+		Text << "\tCHANNELS 6 Xposition Yposition Zposition Zrotation Xrotation Yrotation\n";
+
+		TArray<int32> JointChannels;
+		JointChannels.Reserve(NumJoints);
+		for (int32 Joint = 0; Joint < NumJoints; Joint += ChainLength)
+		{
+			const int32 NumInChain = FMath::Min(ChainLength, NumJoints - Joint);
+			for (int32 Depth = 0; Depth < NumInChain; ++Depth)
+			{
+				const int32 JointIndex = Joint + Depth;
+				const FAnsiStringView Indent("\t\t\t\t\t\t", Depth + 1);
+				Text << Indent << "JOINT Joint" << JointIndex << "\n" << Indent << "{\n";
+				Text << Indent;
+				Text.Appendf("\tOFFSET %.6f %.6f %.6f\n", 1.5 * Depth, 10.0, -2.25);
+				if (JointIndex % 7 == 6)
+				{
+					Text << Indent << "\tCHANNELS 2 Zrotation Xrotation\n";
+					JointChannels.Add(2);
+				}
+				else
+				{
+					Text << Indent << "\tCHANNELS 3 " << RotationOrders[JointIndex % UE_ARRAY_COUNT(RotationOrders)] << "\n";
+					JointChannels.Add(3);
+				}
+			}
+
+			const FAnsiStringView EndIndent("\t\t\t\t\t\t", NumInChain + 1);
+			Text << EndIndent << "End Site\n" << EndIndent << "{\n" << EndIndent << "\tOFFSET 0.000000 5.000000 0.000000\n" << EndIndent << "}\n";
+			for (int32 Depth = NumInChain - 1; Depth >= 0; --Depth)
+			{
+				Text << FAnsiStringView("\t\t\t\t\t\t", Depth + 1) << "}\n";
+			}
+		}
+		Text << "}\nMOTION\nFrames: " << NumFrames << "\nFrame Time: 0.008333\n";
+
+		FRandomStream Random(0x42564821);
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			Text.Appendf("%.6f %.6f %.6f", Random.FRandRange(-100.0f, 100.0f), Random.FRandRange(80.0f, 100.0f), Random.FRandRange(-100.0f, 100.0f));
+			for (int32 Channel = 0; Channel < 3; ++Channel)
+			{
+				Text.Appendf(" %.6f", Random.FRandRange(-180.0f, 180.0f));
+			}
+			for (const int32 NumChannels : JointChannels)
+			{
+				for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+				{
+					Text.Appendf(" %.6f", Random.FRandRange(-180.0f, 180.0f));
+				}
+			}
+			Text << "\n";
+		}
+	}
+
+	// Counts the values that differ from the reference, bit for bit
+	int32 CountMotionMismatches(const FBVHData& Reference, const FBVHData& Data)
+	{
+		if (Reference.Nodes.Num() != Data.Nodes.Num() || Reference.NumChannels != Data.NumChannels
+			|| Reference.NumFrames != Data.NumFrames || Reference.MotionData.Num() != Data.MotionData.Num())
+		{
+			return FMath::Max(Reference.MotionData.Num(), 1);
+		}
+
+		int32 NumMismatches = 0;
+		for (int32 Index = 0; Index < Reference.MotionData.Num(); ++Index)
+		{
+			NumMismatches += FMemory::Memcmp(&Reference.MotionData[Index], &Data.MotionData[Index], sizeof(double)) != 0;
+		}
+		return NumMismatches;
+	}
+
+	void BenchmarkParse(const FString& Filename, int64 NumBytes)
+	{
+		struct FParseVariant
+		{
+			const TCHAR* Label;
+			FBVHParseOptions Options;
+		};
+
+		FParseVariant Variants[3];
+		Variants[0].Label = TEXT("Legacy");
+		Variants[0].Options.Mode = EBVHParseMode::Legacy;
+		Variants[1].Label = TEXT("Tokenized");
+		Variants[1].Options.bParallelMotion = false;
+		Variants[2].Label = TEXT("Tokenized parallel");
+
+		// The legacy line parser is the reference every fast path has to match exactly
+		FBVHData Reference;
+		double ReferenceSeconds = 0.0;
+		for (const FParseVariant& Variant : Variants)
+		{
+			FBVHData Data;
+			bool bParsed = true;
+			const double Seconds = MeasureBest([&Filename, &Variant, &Data, &bParsed]()
+			{
+				Data = FBVHData();
+				FBVHParser Parser(Filename, Variant.Options);
+				bParsed &= Parser.Parse(Data);
+			});
+
+			if (!bParsed)
+			{
+				UE_LOG(LogBVHImporter, Error, TEXT("  %s: failed to parse"), Variant.Label);
+				continue;
+			}
+
+			if (&Variant == &Variants[0])
+			{
+				Reference = MoveTemp(Data);
+				ReferenceSeconds = Seconds;
+				UE_LOG(LogBVHImporter, Display, TEXT("  Parse %-20s %8.1f MB/s %9.2f ms"), Variant.Label, NumBytes / 1e6 / Seconds, Seconds * 1000.0);
+				continue;
+			}
+
+			const int32 NumMismatches = CountMotionMismatches(Reference, Data);
+			UE_LOG(LogBVHImporter, Display, TEXT("  Parse %-20s %8.1f MB/s %9.2f ms %6.1fx"), Variant.Label, NumBytes / 1e6 / Seconds, Seconds * 1000.0, ReferenceSeconds / Seconds);
+			if (NumMismatches > 0)
+			{
+				UE_LOG(LogBVHImporter, Error, TEXT("  %s: %d values differ from Legacy"), Variant.Label, NumMismatches);
+			}
+		}
+	}
+
+	void BenchmarkConversion(const FString& Filename)
+	{
+		FBVHParseOptions ParseOptions;
+		ParseOptions.Layout = EBVHMotionLayout::ChannelMajor;
+		FBVHData Data;
+		if (!FBVHParser(Filename, ParseOptions).Parse(Data))
+		{
+			return;
+		}
+
+		// Rotation channels of every animated node, as the scalar reference takes them
+		struct FRotationTracks
+		{
+			const FBVHNode* Node;
+			TArray<EBVHChannel, TInlineAllocator<3>> Axes;
+			TArray<const double*, TInlineAllocator<3>> AngleTracks;
+			TArray<const double*, TInlineAllocator<6>> NodeTracks;
+		};
+		TArray<FRotationTracks> Bones;
+		for (const FBVHNode& Node : Data.Nodes)
+		{
+			FRotationTracks Bone;
+			Bone.Node = &Node;
+			for (int32 i = 0; i < Node.Channels.Num(); ++i)
+			{
+				const double* Track = Data.MotionData.GetData() + (int64)(Node.ChannelStartIndex + i) * Data.NumFrames;
+				Bone.NodeTracks.Add(Track);
+				if (Node.Channels[i] == EBVHChannel::Xrotation || Node.Channels[i] == EBVHChannel::Yrotation || Node.Channels[i] == EBVHChannel::Zrotation)
+				{
+					Bone.Axes.Add(Node.Channels[i]);
+					Bone.AngleTracks.Add(Track);
+				}
+			}
+			if (Bone.Axes.Num() > 0)
+			{
+				Bones.Add(MoveTemp(Bone));
+			}
+		}
+
+		const int32 NumFrames = Data.NumFrames;
+		const int64 NumKeys = (int64)Bones.Num() * NumFrames;
+		TArray<FQuat> ScalarKeys;
+		TArray<FQuat> BatchKeys;
+		TArray<FQuat> SampledKeys;
+		ScalarKeys.SetNumUninitialized((int32)NumKeys);
+		BatchKeys.SetNumUninitialized((int32)NumKeys);
+		SampledKeys.SetNumUninitialized((int32)NumKeys);
+
+		const double ScalarSeconds = MeasureBest([&Bones, &ScalarKeys, NumFrames]()
+		{
+			for (int32 BoneIndex = 0; BoneIndex < Bones.Num(); ++BoneIndex)
+			{
+				BVHTrackConversion::EulerToQuatScalar(Bones[BoneIndex].Axes, Bones[BoneIndex].AngleTracks, NumFrames, ScalarKeys.GetData() + (int64)BoneIndex * NumFrames);
+			}
+		});
+		const double BatchSeconds = MeasureBest([&Bones, &BatchKeys, NumFrames]()
+		{
+			for (int32 BoneIndex = 0; BoneIndex < Bones.Num(); ++BoneIndex)
+			{
+				BVHTrackConversion::EulerToQuatBatch(Bones[BoneIndex].Axes, Bones[BoneIndex].AngleTracks, NumFrames, BatchKeys.GetData() + (int64)BoneIndex * NumFrames);
+			}
+		});
+		const double SampledSeconds = MeasureBest([&Bones, &SampledKeys, NumFrames]()
+		{
+			for (int32 BoneIndex = 0; BoneIndex < Bones.Num(); ++BoneIndex)
+			{
+				BVHTrackConversion::SampleRotations(*Bones[BoneIndex].Node, Bones[BoneIndex].NodeTracks, NumFrames, SampledKeys.GetData() + (int64)BoneIndex * NumFrames);
+			}
+		});
+
+		// The fast paths use vector sine and cosine and reassociate the products, so they are held to a
+		// tolerance rather than bit equality. A wrong axis or order shows up as an error near one.
+		auto MaxError = [&ScalarKeys](const TArray<FQuat>& Keys)
+		{
+			double Error = 0.0;
+			for (int32 Index = 0; Index < Keys.Num(); ++Index)
+			{
+				const FQuat& A = ScalarKeys[Index];
+				const FQuat& B = Keys[Index];
+				Error = FMath::Max(Error, FMath::Max(FMath::Max(FMath::Abs(A.X - B.X), FMath::Abs(A.Y - B.Y)), FMath::Max(FMath::Abs(A.Z - B.Z), FMath::Abs(A.W - B.W))));
+			}
+			return Error;
+		};
+		constexpr double MaxAllowedError = 1e-6;
+
+		struct FFastPath
+		{
+			const TCHAR* Label;
+			double Seconds;
+			const TArray<FQuat>* Keys;
+		};
+		const FFastPath FastPaths[] =
+		{
+			{ TEXT("Batch"), BatchSeconds, &BatchKeys },
+			{ TEXT("Specialized"), SampledSeconds, &SampledKeys },
+		};
+
+		UE_LOG(LogBVHImporter, Display, TEXT("  Rotations %-14s %8.1f Mkeys/s %8.2f ms"), TEXT("Scalar"), NumKeys / 1e6 / ScalarSeconds, ScalarSeconds * 1000.0);
+		for (const FFastPath& FastPath : FastPaths)
+		{
+			const double Error = MaxError(*FastPath.Keys);
+			UE_LOG(LogBVHImporter, Display, TEXT("  Rotations %-14s %8.1f Mkeys/s %8.2f ms %6.1fx, max error %.2g"), FastPath.Label, NumKeys / 1e6 / FastPath.Seconds, FastPath.Seconds * 1000.0, ScalarSeconds / FastPath.Seconds, Error);
+			if (Error > MaxAllowedError)
+			{
+				UE_LOG(LogBVHImporter, Error, TEXT("  %s rotations differ from the scalar reference by more than %.0g"), FastPath.Label, MaxAllowedError);
+			}
+		}
+
+		// Positions and the whole per-node step the importer runs per chunk, offsets included, into one key
+		// range per node like the bone tracks
+		FBVHMotionChunk Chunk;
+		Chunk.NumFrames = NumFrames;
+		Chunk.NumChannels = Data.NumChannels;
+		Chunk.Values = Data.MotionData;
+
+		TArray<TArray<const double*, TInlineAllocator<6>>> AllNodeTracks;
+		AllNodeTracks.SetNum(Data.Nodes.Num());
+		for (int32 NodeIndex = 0; NodeIndex < Data.Nodes.Num(); ++NodeIndex)
+		{
+			const FBVHNode& Node = Data.Nodes[NodeIndex];
+			for (int32 i = 0; i < Node.Channels.Num(); ++i)
+			{
+				AllNodeTracks[NodeIndex].Add(Chunk.GetChannel(Node.ChannelStartIndex + i).GetData());
+			}
+		}
+
+		const int64 NumNodeKeys = (int64)Data.Nodes.Num() * NumFrames;
+		TArray<FVector> NodePositions;
+		TArray<FQuat> NodeRotations;
+		NodePositions.SetNumUninitialized((int32)NumNodeKeys);
+		NodeRotations.SetNumUninitialized((int32)NumNodeKeys);
+
+		const double PositionSeconds = MeasureBest([&Data, &AllNodeTracks, &NodePositions, NumFrames]()
+		{
+			for (int32 NodeIndex = 0; NodeIndex < Data.Nodes.Num(); ++NodeIndex)
+			{
+				BVHTrackConversion::SamplePositions(Data.Nodes[NodeIndex], AllNodeTracks[NodeIndex], NumFrames, NodePositions.GetData() + (int64)NodeIndex * NumFrames);
+			}
+		});
+		const double NodeSeconds = MeasureBest([&Data, &Chunk, &NodePositions, &NodeRotations, NumFrames]()
+		{
+			for (int32 NodeIndex = 0; NodeIndex < Data.Nodes.Num(); ++NodeIndex)
+			{
+				const int64 FirstKey = (int64)NodeIndex * NumFrames;
+				FBVHTrackConverter::ConvertNodeChunk(Data.Nodes[NodeIndex], Chunk, NodePositions.GetData() + FirstKey, NodeRotations.GetData() + FirstKey);
+			}
+		});
+
+		UE_LOG(LogBVHImporter, Display, TEXT("  Positions %-14s %8.1f Mkeys/s %8.2f ms"), TEXT("Specialized"), NumNodeKeys / 1e6 / PositionSeconds, PositionSeconds * 1000.0);
+		UE_LOG(LogBVHImporter, Display, TEXT("  Nodes     %-14s %8.1f Mkeys/s %8.2f ms"), TEXT("Full"), NumNodeKeys / 1e6 / NodeSeconds, NodeSeconds * 1000.0);
+	}
+
+	void Benchmark(const TArray<FString>& Args)
+	{
+		// Joints x frames, from a body-only take to a hand-capture rig
+		TArray<FIntPoint> Sizes = { { 24, 2000 }, { 64, 10000 }, { 256, 4000 } };
+		if (Args.Num() >= 2)
+		{
+			Sizes = { { FMath::Max(FCString::Atoi(*Args[0]), 1), FMath::Max(FCString::Atoi(*Args[1]), 1) } };
+		}
+
+		const FString Directory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("BVHBenchmark"));
+		for (const FIntPoint& Size : Sizes)
+		{
+			TAnsiStringBuilder<4096> Text;
+			MakeSyntheticBVH(Size.X, Size.Y, Text);
+			const FString Filename = FPaths::Combine(Directory, FString::Printf(TEXT("Synthetic_%dx%d.bvh"), Size.X, Size.Y));
+			if (!FFileHelper::SaveArrayToFile(TArrayView<const uint8>(reinterpret_cast<const uint8*>(Text.GetData()), Text.Len()), *Filename))
+			{
+				UE_LOG(LogBVHImporter, Error, TEXT("BVH.Benchmark: Cannot write %s"), *Filename);
+				return;
+			}
+
+			UE_LOG(LogBVHImporter, Display, TEXT("BVH.Benchmark: %d joints x %d frames, %.1f MB"), Size.X, Size.Y, Text.Len() / 1e6);
+			BenchmarkParse(Filename, Text.Len());
+			BenchmarkConversion(Filename);
+			IFileManager::Get().Delete(*Filename);
+		}
+	}
+
+	FAutoConsoleCommand BenchmarkCommand(
+		TEXT("BVH.Benchmark"),
+		TEXT("Parses synthetic BVH files with every parser mode and converts them with every sampler, checking each fast path against its reference. Usage: BVH.Benchmark [NumJoints NumFrames]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&Benchmark));
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBVHFastFloatTest, "BVHImporter.FastFloat", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FBVHFastFloatTest::RunTest(const FString& Parameters)
+{
+	// The benchmark's motion text plus the forms at the edges of the fast path: signs, zeros, bare points,
+	// exponents at and past 22 and significands past 53 bits
+	TArray<ANSICHAR> Text = MakeMotionText(100000);
+	static const ANSICHAR EdgeCases[] = " 0 -0 +1 -0.000000 .5 5. -.25 0.1 1e5 1E-5 2.5e+22 1e23 1e-23 9007199254740993 123456789012345678901 1e400 ";
+	Text.Append(EdgeCases, UE_ARRAY_COUNT(EdgeCases) - 1);
+
+	FBVHTokenizer Tokenizer(Text.GetData(), Text.GetData() + Text.Num());
+	FAnsiStringView Token;
+	int32 NumTokens = 0;
+	int32 NumFastPath = 0;
+	int32 NumMismatches = 0;
+	while (Tokenizer.NextToken(Token))
+	{
+		++NumTokens;
+		ANSICHAR Buffer[128];
+		const int32 Len = FMath::Min(Token.Len(), (int32)UE_ARRAY_COUNT(Buffer) - 1);
+		FMemory::Memcpy(Buffer, Token.GetData(), Len);
+		Buffer[Len] = '\0';
+
+		// The fast path has to be bit-identical to Atod, and so to Atof once narrowed
+		double FastValue;
+		const bool bFastPath = BVHFastFloat::TryParse(Token.GetData(), Token.GetData() + Token.Len(), FastValue);
+		NumFastPath += bFastPath;
+		const double Value = FBVHTokenizer::ToDouble(Token);
+		const double Reference = FCStringAnsi::Atod(Buffer);
+		const bool bMatches = FMemory::Memcmp(&Value, &Reference, sizeof(double)) == 0
+			&& (!bFastPath || FMemory::Memcmp(&FastValue, &Reference, sizeof(double)) == 0)
+			&& (float)Value == FCStringAnsi::Atof(Buffer);
+		if (!bMatches && ++NumMismatches <= 10)
+		{
+			AddError(FString::Printf(TEXT("'%s' parsed as %.17g, Atod gives %.17g"), *FString(Len, Buffer), Value, Reference));
+		}
+	}
+
+	TestEqual(TEXT("Values that differ from Atod"), NumMismatches, 0);
+	TestTrue(TEXT("Exporter-shaped values take the fast path"), NumFastPath > NumTokens * 9 / 10);
+	return NumMismatches == 0;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
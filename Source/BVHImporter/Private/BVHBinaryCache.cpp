@@ -0,0 +1,247 @@
+#include "BVHBinaryCache.h"
+#include "Async/MappedFileHandle.h"
+#include "BVHImporterLog.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Hash/CityHash.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+
+namespace
+{
+	constexpr uint32 CacheMagic = 0x43485642; // "BVHC"
+	constexpr uint32 CacheVersion = 3;
+
+	// The motion block starts on this boundary so the doubles can be copied out in one aligned run
+	constexpr int64 MotionAlignment = 16;
+
+	struct FCacheHeader
+	{
+		uint32 Magic = CacheMagic;
+		uint32 Version = CacheVersion;
+		int64 SourceSize = 0;
+		uint64 SourceHash = 0;
+		int32 NumNodes = 0;
+		int32 NumChannels = 0;
+		int32 NumFrames = 0;
+		double FrameTime = 0.0;
+		uint8 Layout = 0;
+
+		friend FArchive& operator<<(FArchive& Ar, FCacheHeader& Header)
+		{
+			return Ar << Header.Magic << Header.Version << Header.SourceSize << Header.SourceHash
+				<< Header.NumNodes << Header.NumChannels << Header.NumFrames << Header.FrameTime << Header.Layout;
+		}
+	};
+
+	// A file's bytes, mapped when the platform supports it so only the pages actually read are touched
+	struct FFileBytes
+	{
+		TUniquePtr<IMappedFileHandle> MappedFile;
+		TUniquePtr<IMappedFileRegion> MappedRegion;
+		TArray<uint8> LoadedBytes;
+		TArrayView<const uint8> Bytes;
+
+		bool Open(const FString& Path)
+		{
+			FOpenMappedResult Mapped = FPlatformFileManager::Get().GetPlatformFile().OpenMappedEx(*Path);
+			if (Mapped.HasValue() && Mapped.GetValue()->GetFileSize() > 0 && Mapped.GetValue()->GetFileSize() <= MAX_int32)
+			{
+				MappedFile = Mapped.StealValue();
+				MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+			}
+
+			if (MappedRegion)
+			{
+				Bytes = MakeArrayView(MappedRegion->GetMappedPtr(), (int32)MappedRegion->GetMappedSize());
+				return true;
+			}
+			if (!FFileHelper::LoadFileToArray(LoadedBytes, *Path))
+			{
+				return false;
+			}
+			Bytes = LoadedBytes;
+			return true;
+		}
+	};
+
+	uint64 HashBytes(TArrayView<const uint8> Bytes)
+	{
+		// CityHash takes 32-bit lengths, so the bytes are chained in slices
+		constexpr int32 BytesPerSlice = 64 * 1024 * 1024;
+		uint64 Hash = 0;
+		for (int32 First = 0; First < Bytes.Num(); First += BytesPerSlice)
+		{
+			Hash = CityHash64WithSeed(reinterpret_cast<const char*>(Bytes.GetData() + First), FMath::Min(BytesPerSlice, Bytes.Num() - First), Hash);
+		}
+		return Hash;
+	}
+
+	void SerializeNode(FArchive& Ar, FBVHNode& Node)
+	{
+		// File archives do not serialize FNames, the name goes through as a string
+		FString Name = Node.Name.ToString();
+		Ar << Name;
+		if (Ar.IsLoading())
+		{
+			Node.Name = FName(*Name);
+		}
+		Ar << Node.ParentIndex << Node.NumChildren << Node.Offset << Node.ChannelStartIndex;
+
+		int32 NumChannels = Node.Channels.Num();
+		Ar << NumChannels;
+		if (Ar.IsLoading())
+		{
+			if (NumChannels < 0 || NumChannels > 1024)
+			{
+				Ar.SetError();
+				return;
+			}
+			Node.Channels.SetNumUninitialized(NumChannels);
+		}
+		Ar.Serialize(Node.Channels.GetData(), NumChannels * sizeof(EBVHChannel));
+
+		Ar << reinterpret_cast<uint8&>(Node.RotationOrder) << Node.PositionMask;
+		Ar.Serialize(Node.PositionChannels, sizeof(Node.PositionChannels));
+		Ar.Serialize(Node.RotationChannels, sizeof(Node.RotationChannels));
+	}
+
+}
+
+FString FBVHBinaryCache::GetCachePath(const FString& Filename)
+{
+	// Keyed by path alone, so a new entry for a source overwrites its previous one instead of piling up
+	const FString FullPath = FPaths::ConvertRelativePathToFull(Filename);
+	const uint64 Key = CityHash64(reinterpret_cast<const char*>(*FullPath), FullPath.Len() * sizeof(TCHAR));
+	return FPaths::Combine(FPaths::ProjectIntermediateDir(), TEXT("BVHCache"), FString::Printf(TEXT("%016llx.bvhc"), Key));
+}
+
+bool FBVHBinaryCache::HashSource(const FString& Filename, uint64& OutHash)
+{
+	FFileBytes Source;
+	if (!Source.Open(Filename))
+	{
+		return false;
+	}
+	OutHash = HashBytes(Source.Bytes);
+	return true;
+}
+
+bool FBVHBinaryCache::Load(const FString& Filename, FBVHData& OutData)
+{
+	BVH_SCOPE_CYCLE_COUNTER(STAT_BVHFileLoad);
+	const FString CachePath = GetCachePath(Filename);
+	const int64 SourceSize = IFileManager::Get().FileSize(*Filename);
+	if (SourceSize < 0 || !IFileManager::Get().FileExists(*CachePath))
+	{
+		return false;
+	}
+
+	FFileBytes Entry;
+	if (!Entry.Open(CachePath))
+	{
+		return false;
+	}
+	const TArrayView<const uint8> Bytes = Entry.Bytes;
+
+	FMemoryReaderView Reader(Bytes);
+	FCacheHeader Header;
+	Reader << Header;
+	if (Reader.IsError() || Header.Magic != CacheMagic || Header.Version != CacheVersion || Header.SourceSize != SourceSize
+		|| Header.NumNodes <= 0 || Header.NumChannels < 0 || Header.NumFrames < 0
+		|| Header.Layout > (uint8)EBVHMotionLayout::ChannelMajor)
+	{
+		return false;
+	}
+
+	// Hashing the source streams it once, which is still far cheaper than tokenizing it
+	uint64 SourceHash = 0;
+	if (!HashSource(Filename, SourceHash) || SourceHash != Header.SourceHash)
+	{
+		return false;
+	}
+
+	// Depth-first with parents first, exactly as the parser emits them
+	FBVHData Data;
+	Data.Nodes.SetNum(Header.NumNodes);
+	for (int32 Index = 0; Index < Header.NumNodes; ++Index)
+	{
+		FBVHNode& Node = Data.Nodes[Index];
+		SerializeNode(Reader, Node);
+		if (Reader.IsError() || Node.ParentIndex >= Index || (Index > 0) != (Node.ParentIndex >= 0))
+		{
+			return false;
+		}
+	}
+
+	const int64 MotionStart = Align(Reader.Tell(), MotionAlignment);
+	const int64 NumValues = (int64)Header.NumFrames * Header.NumChannels;
+	if (NumValues > MAX_int32 || MotionStart + NumValues * (int64)sizeof(double) > Bytes.Num())
+	{
+		return false;
+	}
+
+	Data.NumFrames = Header.NumFrames;
+	Data.NumChannels = Header.NumChannels;
+	Data.FrameTime = Header.FrameTime;
+	Data.Layout = (EBVHMotionLayout)Header.Layout;
+	Data.MotionData.SetNumUninitialized((int32)NumValues);
+	FMemory::Memcpy(Data.MotionData.GetData(), Bytes.GetData() + MotionStart, NumValues * sizeof(double));
+
+	OutData = MoveTemp(Data);
+	return true;
+}
+
+bool FBVHBinaryCache::Save(const FString& Filename, const FBVHData& Data)
+{
+	const FString CachePath = GetCachePath(Filename);
+	const int64 SourceSize = IFileManager::Get().FileSize(*Filename);
+	uint64 SourceHash = 0;
+	if (Data.Nodes.Num() == 0 || SourceSize < 0 || !HashSource(Filename, SourceHash))
+	{
+		return false;
+	}
+
+	FCacheHeader Header;
+	Header.SourceSize = SourceSize;
+	Header.SourceHash = SourceHash;
+	Header.NumNodes = Data.Nodes.Num();
+	Header.NumChannels = Data.NumChannels;
+	Header.NumFrames = Data.NumFrames;
+	Header.FrameTime = Data.FrameTime;
+	Header.Layout = (uint8)Data.Layout;
+
+	// Written under a unique name and moved into place, so concurrent imports never read a partial entry
+	const FString TempPath = FPaths::Combine(FPaths::GetPath(CachePath), FGuid::NewGuid().ToString() + TEXT(".tmp"));
+	{
+		TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TempPath));
+		if (!Writer)
+		{
+			return false;
+		}
+
+		*Writer << Header;
+		for (const FBVHNode& Node : Data.Nodes)
+		{
+			SerializeNode(*Writer, const_cast<FBVHNode&>(Node));
+		}
+
+		uint8 Padding[MotionAlignment] = {};
+		Writer->Serialize(Padding, Align(Writer->Tell(), MotionAlignment) - Writer->Tell());
+		Writer->Serialize(const_cast<double*>(Data.MotionData.GetData()), Data.MotionData.Num() * sizeof(double));
+
+		if (!Writer->Close())
+		{
+			IFileManager::Get().Delete(*TempPath);
+			return false;
+		}
+	}
+
+	if (!IFileManager::Get().Move(*CachePath, *TempPath, true, true))
+	{
+		IFileManager::Get().Delete(*TempPath);
+		return false;
+	}
+	return true;
+}
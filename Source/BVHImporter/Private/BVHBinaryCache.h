@@ -0,0 +1,30 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BVHParser.h"
+
+/**
+ * Binary copy of a parsed FBVHData, kept in Intermediate/BVHCache so unchanged files skip the text parse.
+ * A .bvhc file holds a small header, the depth-first hierarchy with its resolved channel layout and the motion
+ * block as raw doubles. There is one entry per source path, so writing a new entry replaces the previous one. The
+ * header records a hash of the source bytes, which Load checks against the file on disk: touching a file keeps its
+ * entry valid, and an edited file misses even when its size and timestamp were preserved.
+ *
+ * Load maps the entry but copies the motion block into FBVHData::MotionData. The importer converts and drops the
+ * motion right after, and an owned array keeps FBVHData free of a mapping it would have to outlive.
+ */
+class FBVHBinaryCache
+{
+public:
+	/** Fills OutData from the cache entry for Filename, false when there is no entry for its current content */
+	static bool Load(const FString& Filename, FBVHData& OutData);
+
+	/** Writes the cache entry for Filename, replacing the previous one */
+	static bool Save(const FString& Filename, const FBVHData& Data);
+
+	/** Cache file the entry for Filename lives in */
+	static FString GetCachePath(const FString& Filename);
+
+	/** CityHash64 of the file's bytes, false when it cannot be read */
+	static bool HashSource(const FString& Filename, uint64& OutHash);
+};
@@ -0,0 +1,247 @@
+#include "BVHImportCommandlet.h"
+#include "Animation/AnimSequence.h"
+#include "Animation/Skeleton.h"
+#include "BVHImportPipeline.h"
+#include "BVHImportSettings.h"
+#include "BVHImporterLog.h"
+#include "Engine/SkeletalMesh.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+#include "UObject/UObjectGlobals.h"
+
+namespace {
+
+// Files imported, saved and released together. Bounds the number of unsaved
+// packages alive at once.
+constexpr int32 DefaultBatchSize = 256;
+
+bool GatherSourceFiles(const FString &Params, TArray<FString> &OutFilenames) {
+  FString SourceDirectory;
+  FString ManifestPath;
+  if (FParse::Value(*Params, TEXT("Source="), SourceDirectory)) {
+    TArray<FString> FoundFiles;
+    IFileManager::Get().FindFilesRecursive(FoundFiles, *SourceDirectory,
+                                           TEXT("*.bvh"), true, false);
+    OutFilenames = MoveTemp(FoundFiles);
+  } else if (FParse::Value(*Params, TEXT("Manifest="), ManifestPath)) {
+    TArray<FString> Lines;
+    if (!FFileHelper::LoadFileToStringArray(Lines, *ManifestPath)) {
+      UE_LOG(LogBVHImporter, Error,
+             TEXT("BVHImportCommandlet: Cannot read %s"), *ManifestPath);
+      return false;
+    }
+
+    const FString ManifestDirectory = FPaths::GetPath(ManifestPath);
+    for (FString &Line : Lines) {
+      Line.TrimStartAndEndInline();
+      if (Line.IsEmpty() || Line.StartsWith(TEXT("#"))) {
+        continue;
+      }
+      OutFilenames.Add(FPaths::IsRelative(Line)
+                           ? FPaths::Combine(ManifestDirectory, Line)
+                           : Line);
+    }
+  } else {
+    UE_LOG(LogBVHImporter, Error,
+           TEXT("BVHImportCommandlet: Pass -Source=<Directory> or "
+                "-Manifest=<File>"));
+    return false;
+  }
+
+  // Every agent sorts the same list, so the shards never overlap
+  OutFilenames.Sort();
+
+  FString Shard;
+  if (FParse::Value(*Params, TEXT("Shard="), Shard)) {
+    FString IndexText;
+    FString CountText;
+    const int32 ShardIndex = Shard.Split(TEXT("/"), &IndexText, &CountText)
+                                 ? FCString::Atoi(*IndexText)
+                                 : -1;
+    const int32 ShardCount = FCString::Atoi(*CountText);
+    if (ShardCount <= 0 || ShardIndex < 0 || ShardIndex >= ShardCount) {
+      UE_LOG(LogBVHImporter, Error,
+             TEXT("BVHImportCommandlet: -Shard expects <Index>/<Count>, got "
+                  "%s"),
+             *Shard);
+      return false;
+    }
+
+    TArray<FString> ShardFilenames;
+    ShardFilenames.Reserve(OutFilenames.Num() / ShardCount + 1);
+    for (int32 Index = ShardIndex; Index < OutFilenames.Num();
+         Index += ShardCount) {
+      ShardFilenames.Add(MoveTemp(OutFilenames[Index]));
+    }
+    OutFilenames = MoveTemp(ShardFilenames);
+  }
+  return true;
+}
+
+// A whole rate such as 30 or a fraction such as 30000/1001
+bool ParseFrameRate(const FString &Text, FFrameRate &OutRate) {
+  FString NumeratorText = Text;
+  FString DenominatorText = TEXT("1");
+  Text.Split(TEXT("/"), &NumeratorText, &DenominatorText);
+  const int32 Numerator = FCString::Atoi(*NumeratorText);
+  const int32 Denominator = FCString::Atoi(*DenominatorText);
+  if (Numerator <= 0 || Denominator <= 0) {
+    return false;
+  }
+  OutRate = FFrameRate(Numerator, Denominator);
+  return true;
+}
+
+bool SavePackages(const TSet<UPackage *> &Packages) {
+  FSavePackageArgs SaveArgs;
+  SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+  SaveArgs.SaveFlags = SAVE_NoError;
+
+  bool bAllSaved = true;
+  for (UPackage *Package : Packages) {
+    const FString PackageFilename = FPackageName::LongPackageNameToFilename(
+        Package->GetName(), FPackageName::GetAssetPackageExtension());
+    if (!UPackage::SavePackage(Package, nullptr, *PackageFilename, SaveArgs)) {
+      UE_LOG(LogBVHImporter, Error,
+             TEXT("BVHImportCommandlet: Failed to save %s"), *PackageFilename);
+      bAllSaved = false;
+    }
+  }
+  return bAllSaved;
+}
+
+} // namespace
+
+UBVHImportCommandlet::UBVHImportCommandlet() {
+  IsClient = false;
+  IsEditor = true;
+  IsServer = false;
+  LogToConsole = true;
+}
+
+int32 UBVHImportCommandlet::Main(const FString &Params) {
+  FString DestinationPath;
+  if (!FParse::Value(*Params, TEXT("Dest="), DestinationPath) ||
+      !FPackageName::IsValidLongPackageName(DestinationPath / TEXT("X"))) {
+    UE_LOG(LogBVHImporter, Error,
+           TEXT("BVHImportCommandlet: Pass -Dest=<LongPackagePath>, e.g. "
+                "-Dest=/Game/Mocap"));
+    return 1;
+  }
+
+  TArray<FString> Filenames;
+  if (!GatherSourceFiles(Params, Filenames)) {
+    return 1;
+  }
+
+  int32 BatchSize = DefaultBatchSize;
+  FParse::Value(*Params, TEXT("BatchSize="), BatchSize);
+  BatchSize = FMath::Max(BatchSize, 1);
+
+  // Farm jobs have no use for undo history. Agents share converted tracks
+  // through the DDC unless -NoDDC is passed.
+  FBVHImportOptions Options;
+  GetDefault<UBVHImportSettings>()->ApplyTo(Options);
+  Options.bTransactional = false;
+  Options.bUseDerivedDataCache = !FParse::Param(*Params, TEXT("NoDDC"));
+  if (FParse::Param(*Params, TEXT("NoBinaryCache"))) {
+    Options.bUseBinaryCache = false;
+  }
+  FString FrameRate;
+  if (FParse::Value(*Params, TEXT("FrameRate="), FrameRate)) {
+    if (!ParseFrameRate(FrameRate, Options.TargetFrameRate)) {
+      UE_LOG(LogBVHImporter, Error,
+             TEXT("BVHImportCommandlet: -FrameRate expects <Rate> or "
+                  "<Numerator>/<Denominator>, got %s"),
+             *FrameRate);
+      return 1;
+    }
+    Options.bKeepSourceFrameRate = false;
+  }
+  if (FParse::Param(*Params, TEXT("KeepSourceFrameRate"))) {
+    Options.bKeepSourceFrameRate = true;
+  }
+  if (FParse::Param(*Params, TEXT("ReduceConstant"))) {
+    Options.bReduceConstantTracks = true;
+  }
+  FParse::Value(*Params, TEXT("FirstFrame="), Options.FirstFrame);
+  FParse::Value(*Params, TEXT("NumFrames="), Options.NumFrames);
+  FParse::Value(*Params, TEXT("FrameStride="), Options.FrameStride);
+  FString BonePatterns;
+  if (FParse::Value(*Params, TEXT("IncludeBones="), BonePatterns, false)) {
+    BonePatterns.ParseIntoArray(Options.IncludeBones, TEXT(","));
+  }
+  if (FParse::Value(*Params, TEXT("ExcludeBones="), BonePatterns, false)) {
+    BonePatterns.ParseIntoArray(Options.ExcludeBones, TEXT(","));
+  }
+  if (FParse::Param(*Params, TEXT("ExcludeEndSites"))) {
+    Options.bExcludeEndSites = true;
+  }
+
+  UE_LOG(LogBVHImporter, Display,
+         TEXT("BVHImportCommandlet: Importing %d files into %s in batches of "
+              "%d"),
+         Filenames.Num(), *DestinationPath, BatchSize);
+
+  const double StartTime = FPlatformTime::Seconds();
+  int64 NumBytes = 0;
+  int32 NumImported = 0;
+  bool bAllSaved = true;
+
+  for (int32 First = 0; First < Filenames.Num(); First += BatchSize) {
+    const TArray<FString> Batch(Filenames.GetData() + First,
+                                FMath::Min(BatchSize, Filenames.Num() - First));
+    for (const FString &Filename : Batch) {
+      NumBytes += FMath::Max<int64>(IFileManager::Get().FileSize(*Filename), 0);
+    }
+
+    // The module's skeleton cache hands every batch after the first the same
+    // skeleton, so only the first batch saves it and its preview mesh
+    const TArray<UAnimSequence *> Imported =
+        BVHImportPipeline::ImportFiles(Batch, DestinationPath, Options);
+    NumImported += Imported.Num();
+
+    TSet<UPackage *> DirtyPackages;
+    for (UAnimSequence *AnimSequence : Imported) {
+      DirtyPackages.Add(AnimSequence->GetPackage());
+      if (USkeleton *Skeleton = AnimSequence->GetSkeleton()) {
+        if (Skeleton->GetPackage()->IsDirty()) {
+          DirtyPackages.Add(Skeleton->GetPackage());
+        }
+        USkeletalMesh *PreviewMesh = Skeleton->GetPreviewMesh();
+        if (PreviewMesh && PreviewMesh->GetPackage()->IsDirty()) {
+          DirtyPackages.Add(PreviewMesh->GetPackage());
+        }
+      }
+    }
+    bAllSaved &= SavePackages(DirtyPackages);
+
+    // Saved sequences are released before the next batch, the skeleton stays
+    // standalone and cached
+    for (UAnimSequence *AnimSequence : Imported) {
+      AnimSequence->ClearFlags(RF_Standalone);
+    }
+    CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+    const double Elapsed = FPlatformTime::Seconds() - StartTime;
+    UE_LOG(LogBVHImporter, Display,
+           TEXT("BVHImportCommandlet: %d / %d files, %.1f files/s"),
+           First + Batch.Num(), Filenames.Num(),
+           (First + Batch.Num()) / FMath::Max(Elapsed, UE_SMALL_NUMBER));
+  }
+
+  const double Seconds =
+      FMath::Max(FPlatformTime::Seconds() - StartTime, UE_SMALL_NUMBER);
+  UE_LOG(LogBVHImporter, Display,
+         TEXT("BVHImportCommandlet: Imported %d of %d files (%.1f MB) in "
+              "%.1f s, %.1f files/s, %.1f MB/s"),
+         NumImported, Filenames.Num(), NumBytes / 1e6, Seconds,
+         NumImported / Seconds, NumBytes / 1e6 / Seconds);
+
+  return NumImported == Filenames.Num() && bAllSaved ? 0 : 1;
+}
@@ -0,0 +1,1730 @@
+#include "BVHImportPipeline.h"
+#include "Algo/AnyOf.h"
+#include "Animation/AnimData/IAnimationDataController.h"
+#include "Animation/AnimData/IAnimationDataModel.h"
+#include "Animation/AnimSequence.h"
+#include "Animation/AnimationSettings.h"
+#include "Animation/Skeleton.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetToolsModule.h"
+#include "Async/ParallelFor.h"
+#include "BVHBinaryCache.h"
+#include "BVHImporterLog.h"
+#include "BVHImportUserData.h"
+#include "BVHImporterModule.h"
+#include "BVHTrackConversion.h"
+#include "BVHTrackConverter.h"
+#include "DerivedDataCacheInterface.h"
+#include "EditorFramework/AssetImportData.h"
+#include "Engine/SkeletalMesh.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Hash/CityHash.h"
+#include "Materials/Material.h"
+#include "MeshDescription.h"
+#include "MeshUtilities.h"
+#include "Misc/ScopeRWLock.h"
+#include "Misc/ScopedSlowTask.h"
+#include "ObjectTools.h"
+#include "ReferenceSkeleton.h"
+#include "Rendering/SkeletalMeshLODImporterData.h"
+#include "Rendering/SkeletalMeshModel.h"
+#include "Rendering/SkeletalMeshRenderData.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "SkeletalMeshAttributes.h"
+#include "Tasks/Task.h"
+#include <atomic>
+
+#define LOCTEXT_NAMESPACE "BVHImportPipeline"
+
+namespace BVHImportPipeline {
+
+// Below this many frames per-bone conversion stays on the calling thread
+static constexpr int32 MinFramesForParallelConversion = 256;
+
+// Nodes are stored parents first, so every bone's parent is already in the
+// modifier when the bone is added
+static int32 BuildSkeletonHierarchy(const FBVHData &Data,
+                                    FReferenceSkeletonModifier &Modifier) {
+  static const FName DefaultBoneName(TEXT("Joint"));
+
+  TArray<FName, TInlineAllocator<128>> BoneNames;
+  BoneNames.Reserve(Data.Nodes.Num());
+  for (const FBVHNode &Node : Data.Nodes) {
+    const FName BoneName = Node.Name.IsNone() ? DefaultBoneName : Node.Name;
+    const int32 ParentBoneIndex =
+        Node.ParentIndex != INDEX_NONE
+            ? Modifier.FindBoneIndex(BoneNames[Node.ParentIndex])
+            : INDEX_NONE;
+    BoneNames.Add(BoneName);
+
+    FMeshBoneInfo BoneInfo(BoneName, BoneName.ToString(), ParentBoneIndex);
+
+    // Transform
+    // BVH Offset is local translation from parent
+    FTransform BoneTransform;
+    BoneTransform.SetLocation(ConvertPos(Node.Offset));
+    BoneTransform.SetRotation(
+        FQuat::Identity); // Base pose usually has 0 rotation in BVH
+    BoneTransform.SetScale3D(FVector::OneVector);
+
+    Modifier.Add(BoneInfo, BoneTransform);
+  }
+  return BoneNames.Num();
+}
+
+// Appends one chunk of frames to the bone's keys, converted in place by the
+// runtime converter.
+static void ConvertBoneChunk(const FBVHNode &Node, const FBVHMotionChunk &Chunk,
+                             FBVHBoneTrack &Track) {
+  const int32 FirstKey = Track.PositionalKeys.AddUninitialized(Chunk.NumFrames);
+  Track.RotationalKeys.AddUninitialized(Chunk.NumFrames);
+  FBVHTrackConverter::ConvertNodeChunk(
+      Node, Chunk, Track.PositionalKeys.GetData() + FirstKey,
+      Track.RotationalKeys.GetData() + FirstKey);
+}
+
+static bool MatchesAnyWildcard(const FString &Name,
+                               const TArray<FString> &Patterns) {
+  return Algo::AnyOf(Patterns, [&Name](const FString &Pattern) {
+    return Name.MatchesWildcard(Pattern);
+  });
+}
+
+static bool PassesBoneFilter(const FBVHNode &Node,
+                             const FBVHImportOptions &Options) {
+  if (Options.bExcludeEndSites && Node.NumChildren == 0 &&
+      Node.Channels.Num() == 0) {
+    return false;
+  }
+  if (Options.IncludeBones.Num() == 0 && Options.ExcludeBones.Num() == 0) {
+    return true;
+  }
+
+  const FString Name = Node.Name.ToString();
+  return (Options.IncludeBones.Num() == 0 ||
+          MatchesAnyWildcard(Name, Options.IncludeBones)) &&
+         !MatchesAnyWildcard(Name, Options.ExcludeBones);
+}
+
+static TSharedRef<const FBVHBoneMapping>
+BuildBoneMapping(const FBVHData &Data, const FBVHImportOptions &Options,
+                 const USkeleton *Skeleton) {
+  TSharedRef<FBVHBoneMapping> Mapping = MakeShared<FBVHBoneMapping>();
+  if (Skeleton) {
+    const FReferenceSkeleton &RefSkeleton = Skeleton->GetReferenceSkeleton();
+    Mapping->NodeBones.SetNumUninitialized(Data.Nodes.Num());
+    for (int32 NodeIndex = 0; NodeIndex < Data.Nodes.Num(); ++NodeIndex) {
+      Mapping->NodeBones[NodeIndex] =
+          RefSkeleton.FindBoneIndex(Data.Nodes[NodeIndex].Name);
+    }
+  }
+
+  // Bones are mapped 1:1 by name, the last node with a given name wins
+  TMap<FName, int32> NodeNameMap;
+  NodeNameMap.Reserve(Data.Nodes.Num());
+  for (int32 NodeIndex = 0; NodeIndex < Data.Nodes.Num(); ++NodeIndex) {
+    const FBVHNode &Node = Data.Nodes[NodeIndex];
+    const bool bOnSkeleton =
+        !Skeleton || Mapping->NodeBones[NodeIndex] != INDEX_NONE;
+    if (bOnSkeleton && PassesBoneFilter(Node, Options)) {
+      NodeNameMap.Add(Node.Name, NodeIndex);
+    }
+  }
+
+  Mapping->TrackNodes.Reserve(NodeNameMap.Num());
+  for (const TPair<FName, int32> &Pair : NodeNameMap) {
+    Mapping->TrackNodes.Add(Pair.Value);
+    Mapping->TrackSignature =
+        HashCombine(Mapping->TrackSignature, GetTypeHash(Pair.Value));
+  }
+
+  UE_LOG(LogBVHImporter, Verbose,
+         TEXT("BVHFactory: Mapped %d of %d joints%s."),
+         Mapping->TrackNodes.Num(), Data.Nodes.Num(),
+         Skeleton ? *FString::Printf(TEXT(" onto %s"), *Skeleton->GetName())
+                  : TEXT(""));
+  return Mapping;
+}
+
+// Everything a mapping depends on. Lookups compare all of it, the hash only
+// picks the bucket, so colliding hierarchies or filters never share a mapping.
+struct FBVHBoneMappingKey {
+  uint32 HierarchyHash = 0;
+  int32 NumNodes = 0;
+  TArray<FString> IncludeBones;
+  TArray<FString> ExcludeBones;
+  bool bExcludeEndSites = false;
+  TWeakObjectPtr<const USkeleton> Skeleton;
+  uint32 SkeletonBonesHash = 0; // Bone names in reference order
+
+  FBVHBoneMappingKey(const FBVHData &Data, uint32 InHierarchyHash,
+                     const FBVHImportOptions &Options,
+                     const USkeleton *InSkeleton)
+      : HierarchyHash(InHierarchyHash), NumNodes(Data.Nodes.Num()),
+        IncludeBones(Options.IncludeBones), ExcludeBones(Options.ExcludeBones),
+        bExcludeEndSites(Options.bExcludeEndSites), Skeleton(InSkeleton) {
+    // A skeleton that gained, lost or renamed bones is mapped again. FName
+    // hashes are enough, the cache never outlives the session.
+    if (InSkeleton) {
+      for (const FMeshBoneInfo &Bone :
+           InSkeleton->GetReferenceSkeleton().GetRawRefBoneInfo()) {
+        SkeletonBonesHash =
+            HashCombine(SkeletonBonesHash, GetTypeHash(Bone.Name));
+      }
+    }
+  }
+
+  bool operator==(const FBVHBoneMappingKey &Other) const {
+    return HierarchyHash == Other.HierarchyHash &&
+           NumNodes == Other.NumNodes &&
+           bExcludeEndSites == Other.bExcludeEndSites &&
+           Skeleton == Other.Skeleton &&
+           SkeletonBonesHash == Other.SkeletonBonesHash &&
+           IncludeBones == Other.IncludeBones &&
+           ExcludeBones == Other.ExcludeBones;
+  }
+
+  friend uint32 GetTypeHash(const FBVHBoneMappingKey &Key) {
+    uint32 Hash = HashCombine(Key.HierarchyHash, Key.SkeletonBonesHash);
+    Hash = HashCombine(Hash, GetTypeHash(Key.Skeleton));
+    return HashCombine(Hash, Key.IncludeBones.Num() + Key.ExcludeBones.Num());
+  }
+};
+
+// Mappings by hierarchy, joint filter and skeleton. Every import shares it,
+// so a batch of takes from one capture setup maps its joints once and no file
+// looks bone names up again. ImportFiles empties it after each batch, and it
+// is capped so single imports never grow it without bound.
+class FBVHBoneMappingCache {
+public:
+  TSharedRef<const FBVHBoneMapping>
+  FindOrBuild(const FBVHData &Data, uint32 HierarchyHash,
+              const FBVHImportOptions &Options, const USkeleton *Skeleton) {
+    FBVHBoneMappingKey Key(Data, HierarchyHash, Options, Skeleton);
+    {
+      FReadScopeLock ReadLock(Lock);
+      if (const TSharedRef<const FBVHBoneMapping> *Mapping =
+              Entries.Find(Key)) {
+        return *Mapping;
+      }
+    }
+
+    TSharedRef<const FBVHBoneMapping> Mapping =
+        BuildBoneMapping(Data, Options, Skeleton);
+    FWriteScopeLock WriteLock(Lock);
+    if (Entries.Num() >= MaxEntries) {
+      Entries.Reset();
+    }
+    Entries.Add(MoveTemp(Key), Mapping);
+    return Mapping;
+  }
+
+  void Reset() {
+    FWriteScopeLock WriteLock(Lock);
+    Entries.Reset();
+  }
+
+private:
+  // Far more hierarchy, filter and skeleton combinations than one session
+  // imports, so the cap only bounds entries for collected skeletons
+  static constexpr int32 MaxEntries = 64;
+
+  FRWLock Lock;
+  TMap<FBVHBoneMappingKey, TSharedRef<const FBVHBoneMapping>> Entries;
+};
+
+static FBVHBoneMappingCache &GetBoneMappingCache() {
+  static FBVHBoneMappingCache Cache;
+  return Cache;
+}
+
+// Hashes the parsed hierarchy and sets up one empty track per mapped joint.
+// Runs as soon as the hierarchy is known, before any motion is read.
+// Tracks left over from the payload's previous file keep their key buffers.
+static void PrepareTracks(FBVHImportPayload &OutPayload,
+                          const FBVHImportOptions &Options,
+                          TArray<const FBVHNode *> &OutBoneNodes) {
+  const FBVHData &Data = OutPayload.Data;
+
+  UE_LOG(LogBVHImporter, Verbose, TEXT("BVHFactory: Parsed nodes. Count: %d"),
+         Data.Nodes.Num());
+
+  // Depth-first names plus child counts pin down the tree shape. Names are
+  // hashed by their text, FName indices differ between sessions and the hash
+  // is part of the DDC key.
+  uint32 HierarchyHash = 0;
+  for (const FBVHNode &Node : Data.Nodes) {
+    HierarchyHash =
+        HashCombine(HierarchyHash, GetTypeHash(Node.Name.ToString()));
+    HierarchyHash = HashCombine(HierarchyHash, Node.NumChildren);
+  }
+  OutPayload.HierarchyHash = HierarchyHash;
+
+  // ChannelStartIndex is assigned by the parser
+  OutPayload.BoneMapping = GetBoneMappingCache().FindOrBuild(
+      Data, HierarchyHash, Options, Options.TargetSkeleton);
+  const TArray<int32> &TrackNodes = OutPayload.BoneMapping->TrackNodes;
+
+  // The header's frame count is only a hint, a short file just leaves slack
+  const int32 ReserveFrames = FMath::Max(Data.NumFrames, 0);
+  OutBoneNodes.Reset(TrackNodes.Num());
+  for (const int32 NodeIndex : TrackNodes) {
+    OutBoneNodes.Add(&Data.Nodes[NodeIndex]);
+  }
+
+  OutPayload.Tracks.SetNum(OutBoneNodes.Num(), EAllowShrinking::No);
+  OutPayload.UnchangedTracks.Init(false, OutBoneNodes.Num());
+  for (int32 BoneIndex = 0; BoneIndex < OutBoneNodes.Num(); ++BoneIndex) {
+    FBVHBoneTrack &Track = OutPayload.Tracks[BoneIndex];
+    Track.BoneName = OutBoneNodes[BoneIndex]->Name;
+    Track.PositionalKeys.Reset(ReserveFrames);
+    Track.RotationalKeys.Reset(ReserveFrames);
+  }
+}
+
+static bool IsCancelled(const FBVHImportOptions &Options) {
+  return Options.Progress && Options.Progress->IsCancelled();
+}
+
+// View of a frame range of a whole take's channel-major motion
+static FBVHMotionChunk ViewMotion(const FBVHData &Data, int32 FirstFrame,
+                                  int32 NumFrames) {
+  FBVHMotionChunk Chunk;
+  Chunk.FirstFrame = FirstFrame;
+  Chunk.NumFrames = NumFrames;
+  Chunk.NumChannels = Data.NumChannels;
+  Chunk.ChannelStride = Data.NumFrames;
+  Chunk.Values = TConstArrayView<double>(Data.MotionData.GetData() + FirstFrame,
+                                         Data.MotionData.Num() - FirstFrame);
+  return Chunk;
+}
+
+// Extends the running hash of every channel by one chunk of its values.
+// Streamed and whole takes hash the same slices of StreamingChunkFrames, so
+// both come out with the same hashes.
+static void HashChannels(const FBVHMotionChunk &Chunk,
+                         TArray<uint64> &ChannelHashes) {
+  for (int32 Channel = 0; Channel < Chunk.NumChannels; ++Channel) {
+    const TConstArrayView<double> Values = Chunk.GetChannel(Channel);
+    ChannelHashes[Channel] = CityHash64WithSeed(
+        reinterpret_cast<const char *>(Values.GetData()),
+        Values.Num() * sizeof(double), ChannelHashes[Channel]);
+  }
+}
+
+// Bump whenever the conversion math changes, so reimports convert every track
+static constexpr uint64 SourceHashVersion = 1;
+
+// Hashes what each track's keys are converted from: the joint's raw channel
+// blocks, offset, channel layout and rotation order. The seed covers the
+// frame time and the settings that shape the keys, so a new rate, key count
+// or reduction converts every track. Tracks matching the previous import's
+// hash are flagged unchanged.
+static void HashSources(const TArray<const FBVHNode *> &BoneNodes,
+                        TConstArrayView<uint64> ChannelHashes,
+                        FBVHImportPayload &OutPayload,
+                        const FBVHImportOptions &Options) {
+  const bool bReduce = Options.bReduceConstantTracks;
+  const double Settings[] = {
+      OutPayload.Data.FrameTime,
+      static_cast<double>(OutPayload.FrameRate.Numerator),
+      static_cast<double>(OutPayload.FrameRate.Denominator),
+      static_cast<double>(OutPayload.NumKeys),
+      bReduce ? 1.0 : 0.0,
+      bReduce ? Options.ConstantPositionTolerance : 0.0,
+      bReduce ? Options.ConstantRotationTolerance : 0.0};
+  const uint64 Seed = CityHash64WithSeed(
+      reinterpret_cast<const char *>(Settings), sizeof(Settings),
+      SourceHashVersion);
+
+  OutPayload.SourceHashes.SetNumUninitialized(BoneNodes.Num());
+  for (int32 BoneIndex = 0; BoneIndex < BoneNodes.Num(); ++BoneIndex) {
+    const FBVHNode &Node = *BoneNodes[BoneIndex];
+    uint64 Hash = Seed;
+    for (int32 i = 0; i < Node.Channels.Num(); ++i) {
+      Hash = CityHash128to64({Hash, ChannelHashes[Node.ChannelStartIndex + i]});
+    }
+    Hash = CityHash64WithSeed(reinterpret_cast<const char *>(&Node.Offset),
+                              sizeof(Node.Offset), Hash);
+    Hash = CityHash64WithSeed(
+        reinterpret_cast<const char *>(Node.Channels.GetData()),
+        Node.Channels.Num() * sizeof(EBVHChannel), Hash);
+    Hash = CityHash64WithSeed(
+        reinterpret_cast<const char *>(&Node.RotationOrder),
+        sizeof(Node.RotationOrder), Hash);
+    OutPayload.SourceHashes[BoneIndex] = Hash;
+
+    const uint64 *PreviousHash = Options.PreviousSourceHashes.Find(
+        OutPayload.Tracks[BoneIndex].BoneName);
+    OutPayload.UnchangedTracks[BoneIndex] =
+        PreviousHash && *PreviousHash == Hash;
+  }
+}
+
+// Bones are independent, so the key computation fans out across workers;
+// only the controller commit on the game thread is serial
+static void ConvertChunk(const TArray<const FBVHNode *> &BoneNodes,
+                         const FBVHMotionChunk &Chunk,
+                         FBVHImportPayload &OutPayload,
+                         const FBVHImportOptions &Options) {
+  BVH_SCOPE_CYCLE_COUNTER(STAT_BVHKeyConversion);
+  // Short takes are not worth the scheduling overhead
+  const EParallelForFlags ParallelFlags =
+      Chunk.NumFrames < MinFramesForParallelConversion
+          ? EParallelForFlags::ForceSingleThread
+          : EParallelForFlags::None;
+  ParallelFor(
+      BoneNodes.Num(),
+      [&BoneNodes, &Chunk, &OutPayload](int32 BoneIndex) {
+        if (!OutPayload.UnchangedTracks[BoneIndex]) {
+          ConvertBoneChunk(*BoneNodes[BoneIndex], Chunk,
+                           OutPayload.Tracks[BoneIndex]);
+        }
+      },
+      ParallelFlags);
+
+  if (Options.Progress) {
+    Options.Progress->FramesConverted.fetch_add(Chunk.NumFrames,
+                                                std::memory_order_relaxed);
+  }
+}
+
+// Frame Time is stored in seconds, so common capture rates come out as
+// 119.99999 and are snapped back to whole frames per second
+static FFrameRate GetSourceFrameRate(const FBVHData &Data) {
+  if (Data.FrameTime <= 0.0) {
+    return UAnimationSettings::Get()->GetDefaultFrameRate();
+  }
+
+  const double FramesPerSecond = 1.0 / Data.FrameTime;
+  const int32 WholeFramesPerSecond = FMath::RoundToInt32(FramesPerSecond);
+  if (FMath::IsNearlyEqual(FramesPerSecond, (double)WholeFramesPerSecond,
+                           1e-3)) {
+    return FFrameRate(FMath::Max(WholeFramesPerSecond, 1), 1);
+  }
+  return FFrameRate(FMath::RoundToInt32(FramesPerSecond * 1000.0), 1000);
+}
+
+// Keys leave the pipeline at the target rate, so the sequence plays back with
+// the capture's timing whatever rate the file was recorded at
+static FFrameRate GetTargetFrameRate(const FBVHData &Data,
+                                     const FBVHImportOptions &Options) {
+  if (Options.bKeepSourceFrameRate) {
+    return GetSourceFrameRate(Data);
+  }
+  return Options.TargetFrameRate.IsValid()
+             ? Options.TargetFrameRate
+             : UAnimationSettings::Get()->GetDefaultFrameRate();
+}
+
+// Where one output key samples the source: the frame before it and the blend
+// toward the frame after
+struct FBVHResampleKey {
+  int32 Index;
+  double Alpha;
+};
+
+// Places every key at TargetRate on the file's Frame Time. The source position
+// of a key is the same for all bones, so it is computed once per take. Returns
+// false when the take is too short to blend.
+static bool BuildResampleKeys(const FBVHData &Data, FFrameRate TargetRate,
+                              TArray<FBVHResampleKey> &OutKeys) {
+  const int32 NumSourceKeys = Data.NumFrames;
+  if (NumSourceKeys < 2 || Data.FrameTime <= 0.0) {
+    return false;
+  }
+
+  const double Duration = (NumSourceKeys - 1) * Data.FrameTime;
+  const int32 NumTargetKeys =
+      FMath::FloorToInt32(Duration * TargetRate.AsDecimal() +
+                          UE_KINDA_SMALL_NUMBER) +
+      1;
+  OutKeys.SetNumUninitialized(NumTargetKeys);
+  for (int32 Key = 0; Key < NumTargetKeys; ++Key) {
+    const double SourcePosition =
+        TargetRate.AsSeconds(FFrameTime(Key)) / Data.FrameTime;
+    const int32 Index =
+        FMath::Clamp(FMath::FloorToInt32(SourcePosition), 0, NumSourceKeys - 2);
+    OutKeys[Key] = {Index, FMath::Clamp(SourcePosition - Index, 0.0, 1.0)};
+  }
+  return true;
+}
+
+// Replaces every track's keys by the blend of the keys each resample key
+// brackets: lerp for positions, slerp for rotations. Indices refer to the
+// keys the tracks hold now.
+static void BlendTracks(FBVHImportPayload &Payload,
+                        const TArray<FBVHResampleKey> &ResampleKeys) {
+  const int32 NumTargetKeys = ResampleKeys.Num();
+  const EParallelForFlags ParallelFlags =
+      NumTargetKeys < MinFramesForParallelConversion
+          ? EParallelForFlags::ForceSingleThread
+          : EParallelForFlags::None;
+  // Each worker blends into its own scratch pair from the payload's arena, so
+  // after the first file no bone allocates
+  const int32 NumContexts = ParallelForImpl::GetNumberOfThreadTasks(
+      Payload.Tracks.Num(), 1, ParallelFlags);
+  if (Payload.Scratch.Num() < NumContexts) {
+    Payload.Scratch.SetNum(NumContexts);
+  }
+
+  ParallelForWithTaskContext(
+      TEXT("BVHResampleTracks"), MakeArrayView(Payload.Scratch),
+      Payload.Tracks.Num(), 1,
+      [&Payload, &ResampleKeys, NumTargetKeys](FBVHScratchBuffers &Scratch,
+                                                int32 TrackIndex) {
+        // Unchanged tracks were never converted
+        if (Payload.UnchangedTracks[TrackIndex]) {
+          return;
+        }
+
+        FBVHBoneTrack &Track = Payload.Tracks[TrackIndex];
+        TArray<FVector> &Positions = Scratch.Positions;
+        TArray<FQuat> &Rotations = Scratch.Rotations;
+        Positions.SetNumUninitialized(NumTargetKeys, EAllowShrinking::No);
+        Rotations.SetNumUninitialized(NumTargetKeys, EAllowShrinking::No);
+
+        const FVector *SourcePositions = Track.PositionalKeys.GetData();
+        const FQuat *SourceRotations = Track.RotationalKeys.GetData();
+        for (int32 Key = 0; Key < NumTargetKeys; ++Key) {
+          const FBVHResampleKey &Source = ResampleKeys[Key];
+          const int32 Index = Source.Index;
+          Positions[Key] = FMath::Lerp(SourcePositions[Index],
+                                       SourcePositions[Index + 1],
+                                       Source.Alpha);
+          Rotations[Key] =
+              FQuat::Slerp(SourceRotations[Index], SourceRotations[Index + 1],
+                           Source.Alpha);
+        }
+
+        // The track takes the blended buffers and the scratch keeps the
+        // source ones for the next bone
+        Swap(Track.PositionalKeys, Positions);
+        Swap(Track.RotationalKeys, Rotations);
+      },
+      ParallelFlags);
+}
+
+static void LogResample(const FBVHImportPayload &Payload,
+                        FFrameRate TargetRate, int32 NumTargetKeys) {
+  UE_LOG(LogBVHImporter, Verbose,
+         TEXT("BVHFactory: Resampled %s from %d keys at %.3f fps to %d keys at "
+              "%.3f fps."),
+         *Payload.Filename, Payload.Data.NumFrames,
+         1.0 / Payload.Data.FrameTime, NumTargetKeys, TargetRate.AsDecimal());
+}
+
+// Resamples a whole take's motion to the target rate while converting it.
+// Only the source frames some output key brackets are gathered out of the
+// channel tracks and converted, so a take recorded faster than its target
+// rate converts a fraction of its frames, then the converted pairs are
+// blended into the output keys.
+static void ConvertResampled(const TArray<const FBVHNode *> &BoneNodes,
+                             TArray<FBVHResampleKey> &ResampleKeys,
+                             FBVHImportPayload &OutPayload,
+                             const FBVHImportOptions &Options) {
+  const FBVHData &Data = OutPayload.Data;
+
+  // Keys advance monotonically, so each key's frame is the last or second to
+  // last frame collected so far and the pair stays adjacent once collected
+  TArray<int32> &SourceFrames = OutPayload.SampledFrames;
+  SourceFrames.Reset();
+  for (FBVHResampleKey &Key : ResampleKeys) {
+    if (SourceFrames.Num() == 0 || SourceFrames.Last() < Key.Index) {
+      SourceFrames.Add(Key.Index);
+    }
+    if (SourceFrames.Last() < Key.Index + 1) {
+      SourceFrames.Add(Key.Index + 1);
+    }
+    Key.Index = SourceFrames.Num() - 2;
+  }
+  const int32 NumSampled = SourceFrames.Num();
+
+  // A take that needs every frame is converted from the motion as it is
+  TConstArrayView<double> Motion = Data.MotionData;
+  if (NumSampled < Data.NumFrames) {
+    BVH_SCOPE_CYCLE_COUNTER(STAT_BVHKeyConversion);
+    TArray<double> &Sampled = OutPayload.SampledMotion;
+    Sampled.SetNumUninitialized(Data.NumChannels * NumSampled,
+                                EAllowShrinking::No);
+    for (int32 Channel = 0; Channel < Data.NumChannels; ++Channel) {
+      const double *Source = Data.MotionData.GetData() +
+                             static_cast<int64>(Channel) * Data.NumFrames;
+      double *Dest =
+          Sampled.GetData() + static_cast<int64>(Channel) * NumSampled;
+      for (int32 Frame = 0; Frame < NumSampled; ++Frame) {
+        Dest[Frame] = Source[SourceFrames[Frame]];
+      }
+    }
+    Motion = Sampled;
+  }
+
+  const int32 ChunkFrames = FMath::Max(Options.StreamingChunkFrames, 1);
+  for (int32 First = 0; First < NumSampled && !IsCancelled(Options);
+       First += ChunkFrames) {
+    FBVHMotionChunk Chunk;
+    Chunk.FirstFrame = First;
+    Chunk.NumFrames = FMath::Min(ChunkFrames, NumSampled - First);
+    Chunk.NumChannels = Data.NumChannels;
+    Chunk.ChannelStride = NumSampled;
+    Chunk.Values =
+        TConstArrayView<double>(Motion.GetData() + First, Motion.Num() - First);
+    ConvertChunk(BoneNodes, Chunk, OutPayload, Options);
+  }
+  if (IsCancelled(Options)) {
+    return;
+  }
+
+  // Frames no key needs count as converted
+  if (Options.Progress) {
+    Options.Progress->FramesConverted.fetch_add(Data.NumFrames - NumSampled,
+                                                std::memory_order_relaxed);
+  }
+
+  {
+    BVH_SCOPE_CYCLE_COUNTER(STAT_BVHKeyConversion);
+    BlendTracks(OutPayload, ResampleKeys);
+  }
+  LogResample(OutPayload, OutPayload.FrameRate, ResampleKeys.Num());
+}
+
+// Resamples tracks that were converted at the file's Frame Time. Streamed
+// takes arrive chunk by chunk and their frame count is only known at the end,
+// so they are converted first and blended afterwards.
+static void ResampleTracks(FBVHImportPayload &Payload, FFrameRate TargetRate) {
+  BVH_SCOPE_CYCLE_COUNTER(STAT_BVHKeyConversion);
+  TArray<FBVHResampleKey> ResampleKeys;
+  if (!BuildResampleKeys(Payload.Data, TargetRate, ResampleKeys)) {
+    return;
+  }
+
+  BlendTracks(Payload, ResampleKeys);
+  LogResample(Payload, TargetRate, ResampleKeys.Num());
+  Payload.NumKeys = ResampleKeys.Num();
+}
+
+// Collapses tracks whose position and rotation never leave the first key's
+// tolerance to a single key, which the data model holds for the whole
+// sequence. Raw tracks are uniformly sampled with one key count shared by the
+// position, rotation and scale arrays, so partially constant or linear tracks
+// keep every key and are left to animation compression.
+static void ReduceConstantTracks(FBVHImportPayload &Payload,
+                                 const FBVHImportOptions &Options) {
+  BVH_SCOPE_CYCLE_COUNTER(STAT_BVHKeyConversion);
+  const double PositionToleranceSquared =
+      FMath::Square(Options.ConstantPositionTolerance);
+  // |q0 . q| >= cos(theta / 2) is the angle test without an acos per key
+  const double MinRotationDot =
+      FMath::Cos(FMath::DegreesToRadians(Options.ConstantRotationTolerance) *
+                 0.5);
+
+  // A short take scans its tracks faster than the workers wake up
+  const EParallelForFlags ParallelFlags =
+      Payload.NumKeys < MinFramesForParallelConversion
+          ? EParallelForFlags::ForceSingleThread
+          : EParallelForFlags::None;
+  std::atomic<int32> NumReduced = 0;
+  ParallelFor(
+      Payload.Tracks.Num(),
+      [&Payload, &NumReduced, PositionToleranceSquared,
+       MinRotationDot](int32 TrackIndex) {
+        FBVHBoneTrack &Track = Payload.Tracks[TrackIndex];
+        const int32 NumKeys = Track.PositionalKeys.Num();
+        if (NumKeys < 2) {
+          return;
+        }
+
+        const FVector FirstPosition = Track.PositionalKeys[0];
+        const FQuat FirstRotation = Track.RotationalKeys[0];
+        for (int32 Key = 1; Key < NumKeys; ++Key) {
+          if (FVector::DistSquared(Track.PositionalKeys[Key], FirstPosition) >
+                  PositionToleranceSquared ||
+              FMath::Abs(Track.RotationalKeys[Key] | FirstRotation) <
+                  MinRotationDot) {
+            return;
+          }
+        }
+
+        Track.PositionalKeys.SetNum(1, EAllowShrinking::No);
+        Track.RotationalKeys.SetNum(1, EAllowShrinking::No);
+        ++NumReduced;
+      },
+      ParallelFlags);
+
+  UE_LOG(LogBVHImporter, Verbose,
+         TEXT("BVHFactory: Collapsed %d of %d tracks in %s to a single key."),
+         NumReduced.load(), Payload.Tracks.Num(), *Payload.Filename);
+}
+
+// Bump whenever the conversion math or the cached track layout changes
+#define BVH_TRACKS_DERIVEDDATA_VER TEXT("0C5D1E6A9B2F4E47A3D8B61F27C4E950")
+
+// The motion values, channel layout, hierarchy and target rate fully determine
+// the converted keys, so the key is independent of file paths and machines
+static FString BuildTracksCacheKey(const FBVHImportPayload &Payload) {
+  const FBVHData &Data = Payload.Data;
+  // CityHash takes 32-bit lengths, so long takes are hashed in slices
+  constexpr int32 ValuesPerSlice = 16 * 1024 * 1024;
+  uint64 ContentHash = 0;
+  for (int32 First = 0; First < Data.MotionData.Num();
+       First += ValuesPerSlice) {
+    const int32 Count =
+        FMath::Min(ValuesPerSlice, Data.MotionData.Num() - First);
+    ContentHash = CityHash64WithSeed(
+        reinterpret_cast<const char *>(Data.MotionData.GetData() + First),
+        Count * sizeof(double), ContentHash);
+  }
+  for (const FBVHNode &Node : Data.Nodes) {
+    ContentHash = CityHash64WithSeed(
+        reinterpret_cast<const char *>(Node.Channels.GetData()),
+        Node.Channels.Num() * sizeof(EBVHChannel), ContentHash);
+    // Joints without position channels take their keys from the offset
+    ContentHash = CityHash64WithSeed(
+        reinterpret_cast<const char *>(&Node.Offset), sizeof(FVector),
+        ContentHash);
+  }
+  // Tracks are cached at the rate they were resampled to
+  ContentHash = CityHash64WithSeed(
+      reinterpret_cast<const char *>(&Data.FrameTime), sizeof(double),
+      ContentHash);
+
+  const FString KeySuffix = FString::Printf(
+      TEXT("%016llx_%08x_%08x_%d_%d_%d_%d"), ContentHash,
+      Payload.HierarchyHash, Payload.BoneMapping->TrackSignature,
+      Data.NumFrames, Data.NumChannels, Payload.FrameRate.Numerator,
+      Payload.FrameRate.Denominator);
+  return FDerivedDataCacheInterface::BuildCacheKey(
+      TEXT("BVHTRACKS"), BVH_TRACKS_DERIVEDDATA_VER, *KeySuffix);
+}
+
+static bool LoadTracksFromDDC(const FString &CacheKey,
+                              FBVHImportPayload &OutPayload) {
+  TArray<uint8> CachedData;
+  if (!GetDerivedDataCacheRef().GetSynchronous(*CacheKey, CachedData,
+                                                OutPayload.Filename)) {
+    return false;
+  }
+
+  // A short or corrupt record must not leave keys behind in the payload, the
+  // fallback conversion appends to the tracks
+  FMemoryReader Reader(CachedData);
+  int32 NumTracks = 0;
+  Reader << NumTracks;
+  if (Reader.IsError() || NumTracks != OutPayload.Tracks.Num()) {
+    return false;
+  }
+
+  TArray<FBVHBoneTrack> CachedTracks;
+  CachedTracks.SetNum(NumTracks);
+  for (int32 TrackIndex = 0; TrackIndex < NumTracks; ++TrackIndex) {
+    FBVHBoneTrack &Cached = CachedTracks[TrackIndex];
+    FName BoneName;
+    Reader << BoneName << Cached.PositionalKeys << Cached.RotationalKeys;
+    if (Reader.IsError() ||
+        BoneName != OutPayload.Tracks[TrackIndex].BoneName ||
+        Cached.PositionalKeys.Num() != Cached.RotationalKeys.Num()) {
+      return false;
+    }
+  }
+
+  for (int32 TrackIndex = 0; TrackIndex < NumTracks; ++TrackIndex) {
+    FBVHBoneTrack &Track = OutPayload.Tracks[TrackIndex];
+    Track.PositionalKeys = MoveTemp(CachedTracks[TrackIndex].PositionalKeys);
+    Track.RotationalKeys = MoveTemp(CachedTracks[TrackIndex].RotationalKeys);
+  }
+
+  UE_LOG(LogBVHImporter, Verbose,
+         TEXT("BVHFactory: Pulled converted tracks for %s from the DDC."),
+         *OutPayload.Filename);
+  return true;
+}
+
+static void StoreTracksInDDC(const FString &CacheKey,
+                             const FBVHImportPayload &Payload) {
+  // Scaling keys are always one, so only positions and rotations are stored
+  TArray<uint8> CachedData;
+  FMemoryWriter Writer(CachedData);
+  int32 NumTracks = Payload.Tracks.Num();
+  Writer << NumTracks;
+  for (const FBVHBoneTrack &Track : Payload.Tracks) {
+    FName BoneName = Track.BoneName;
+    Writer << BoneName;
+    Writer << const_cast<TArray<FVector> &>(Track.PositionalKeys);
+    Writer << const_cast<TArray<FQuat> &>(Track.RotationalKeys);
+  }
+
+  GetDerivedDataCacheRef().Put(*CacheKey, CachedData, Payload.Filename);
+}
+
+// Unchanged files read back their binary cache entry instead of the text.
+// Ranged parses neither read nor write it, an entry always holds the whole
+// take.
+static bool LoadCachedOrParse(const FString &Filename, FBVHParser &Parser,
+                              FBVHData &OutData,
+                              const FBVHImportOptions &Options, bool bRanged) {
+  const bool bUseBinaryCache = Options.bUseBinaryCache && !bRanged;
+  if (bUseBinaryCache && FBVHBinaryCache::Load(Filename, OutData)) {
+    UE_LOG(LogBVHImporter, Verbose,
+           TEXT("BVHFactory: Loaded %s from the binary cache."), *Filename);
+    OutData.ConvertToLayout(EBVHMotionLayout::ChannelMajor);
+    return true;
+  }
+
+  if (!Parser.Parse(OutData)) {
+    return false;
+  }
+
+  if (bUseBinaryCache && !FBVHBinaryCache::Save(Filename, OutData)) {
+    UE_LOG(LogBVHImporter, Warning,
+           TEXT("BVHFactory: Could not write the binary cache for %s."),
+           *Filename);
+  }
+  return true;
+}
+
+bool ParseAndConvert(const FString &Filename, FBVHImportPayload &OutPayload,
+                     const FBVHImportOptions &Options) {
+  TRACE_CPUPROFILER_EVENT_SCOPE(BVHImportPipeline::ParseAndConvert);
+  const double StartTime = FPlatformTime::Seconds();
+  OutPayload.Reset();
+  OutPayload.Filename = Filename;
+  FBVHData &Data = OutPayload.Data;
+
+  // Channel-major so each bone's channels are contiguous tracks
+  FBVHParseOptions ParseOptions;
+  ParseOptions.Layout = EBVHMotionLayout::ChannelMajor;
+  ParseOptions.ChunkFrames = Options.StreamingChunkFrames;
+  ParseOptions.FirstFrame = Options.FirstFrame;
+  ParseOptions.NumFrames = Options.NumFrames;
+  ParseOptions.FrameStride = Options.FrameStride;
+  FBVHParser Parser(Filename, ParseOptions);
+  const bool bRanged = ParseOptions.HasFrameWindow();
+  TArray<const FBVHNode *> BoneNodes;
+  TArray<uint64> ChannelHashes;
+
+  const int64 FileSize = IFileManager::Get().FileSize(*Filename);
+  OutPayload.FileSize = FMath::Max<int64>(FileSize, 0);
+  bool bParsed = false;
+  const bool bStreaming = Options.StreamingThresholdBytes > 0 &&
+                          FileSize >= Options.StreamingThresholdBytes;
+  if (bStreaming) {
+    // Motion never exists as a whole, each chunk is converted into the keys
+    // and dropped
+    UE_LOG(LogBVHImporter, Log,
+           TEXT("BVHFactory: Streaming %s (%lld bytes) in chunks of %d "
+                "frames."),
+           *Filename, FileSize, ParseOptions.ChunkFrames);
+    bParsed = Parser.ParseStreaming(
+        Data,
+        [&OutPayload, &BoneNodes, &ChannelHashes,
+         &Options](const FBVHData &Header) {
+          PrepareTracks(OutPayload, Options, BoneNodes);
+          ChannelHashes.SetNumZeroed(Header.NumChannels);
+          if (Options.Progress) {
+            Options.Progress->FramesTotal.fetch_add(
+                FMath::Max(Header.NumFrames, 0), std::memory_order_relaxed);
+          }
+        },
+        [&OutPayload, &BoneNodes, &ChannelHashes,
+         &Options](const FBVHMotionChunk &Chunk) {
+          HashChannels(Chunk, ChannelHashes);
+          ConvertChunk(BoneNodes, Chunk, OutPayload, Options);
+          return !IsCancelled(Options);
+        });
+  } else if (LoadCachedOrParse(Filename, Parser, Data, Options, bRanged) &&
+             Data.Nodes.Num() > 0 && !IsCancelled(Options)) {
+    PrepareTracks(OutPayload, Options, BoneNodes);
+    if (Options.Progress) {
+      Options.Progress->FramesTotal.fetch_add(Data.NumFrames,
+                                              std::memory_order_relaxed);
+    }
+
+    // The whole motion is at hand, so resampling picks the source frames it
+    // needs before anything is converted
+    OutPayload.FrameRate = GetTargetFrameRate(Data, Options);
+    TArray<FBVHResampleKey> ResampleKeys;
+    const bool bResample =
+        OutPayload.FrameRate != GetSourceFrameRate(Data) &&
+        BuildResampleKeys(Data, OutPayload.FrameRate, ResampleKeys);
+    OutPayload.NumKeys = bResample ? ResampleKeys.Num() : Data.NumFrames;
+
+    // Joints whose source matches the previous import are never converted
+    const int32 ChunkFrames = FMath::Max(Options.StreamingChunkFrames, 1);
+    ChannelHashes.SetNumZeroed(Data.NumChannels);
+    for (int32 First = 0; First < Data.NumFrames; First += ChunkFrames) {
+      const int32 NumFrames = FMath::Min(ChunkFrames, Data.NumFrames - First);
+      HashChannels(ViewMotion(Data, First, NumFrames), ChannelHashes);
+    }
+    HashSources(BoneNodes, ChannelHashes, OutPayload, Options);
+    const int32 NumUnchanged = OutPayload.UnchangedTracks.CountSetBits();
+
+    // The DDC only holds complete sets of tracks
+    const FString TracksCacheKey =
+        Options.bUseDerivedDataCache && !bRanged && NumUnchanged == 0
+            ? BuildTracksCacheKey(OutPayload)
+            : FString();
+    if (NumUnchanged == OutPayload.Tracks.Num()) {
+      UE_LOG(LogBVHImporter, Verbose,
+             TEXT("BVHFactory: Every joint of %s is unchanged."), *Filename);
+      if (Options.Progress) {
+        Options.Progress->FramesConverted.fetch_add(Data.NumFrames,
+                                                    std::memory_order_relaxed);
+      }
+    } else if (TracksCacheKey.IsEmpty() ||
+               !LoadTracksFromDDC(TracksCacheKey, OutPayload)) {
+      if (bResample) {
+        ConvertResampled(BoneNodes, ResampleKeys, OutPayload, Options);
+      } else {
+        // Converted in chunks of the streaming size, so progress advances and
+        // a cancel lands between chunks. Each chunk views its frame range of
+        // the take's channel-major motion.
+        for (int32 First = 0; First < Data.NumFrames && !IsCancelled(Options);
+             First += ChunkFrames) {
+          const int32 NumFrames =
+              FMath::Min(ChunkFrames, Data.NumFrames - First);
+          ConvertChunk(BoneNodes, ViewMotion(Data, First, NumFrames),
+                       OutPayload, Options);
+        }
+      }
+
+      if (!TracksCacheKey.IsEmpty() && !IsCancelled(Options)) {
+        StoreTracksInDDC(TracksCacheKey, OutPayload);
+      }
+    } else if (Options.Progress) {
+      Options.Progress->FramesConverted.fetch_add(Data.NumFrames,
+                                                  std::memory_order_relaxed);
+    }
+    Data.MotionData.Empty();
+    bParsed = true;
+  }
+
+  if (IsCancelled(Options)) {
+    UE_LOG(LogBVHImporter, Log, TEXT("BVHFactory: Import of %s was cancelled."),
+           *Filename);
+    return false;
+  }
+
+  if (!bParsed) {
+    UE_LOG(LogBVHImporter, Error,
+           TEXT("BVHFactory: Failed to parse BVH file %s."), *Filename);
+    return false;
+  }
+
+  if (Data.Nodes.Num() == 0) {
+    UE_LOG(LogBVHImporter, Error,
+           TEXT("BVHFactory: Hierarchy is empty after parsing."));
+    return false;
+  }
+
+  UE_LOG(LogBVHImporter, Verbose,
+         TEXT("BVHFactory: Parsing successful. RootNode: %s, Frames: %d"),
+         *Data.Nodes[0].Name.ToString(), Data.NumFrames);
+
+  // Streamed takes were converted at the file's rate and are resampled now
+  if (bStreaming) {
+    OutPayload.FrameRate = GetTargetFrameRate(Data, Options);
+    OutPayload.NumKeys = Data.NumFrames;
+    if (OutPayload.FrameRate != GetSourceFrameRate(Data)) {
+      ResampleTracks(OutPayload, OutPayload.FrameRate);
+    }
+    // Every joint was converted on the way, the hashes only let the reimport
+    // skip rewriting the unchanged tracks
+    HashSources(BoneNodes, ChannelHashes, OutPayload, Options);
+  }
+
+  if (Options.bReduceConstantTracks) {
+    ReduceConstantTracks(OutPayload, Options);
+  }
+
+  if (IsCancelled(Options)) {
+    return false;
+  }
+
+  OutPayload.ScalingKeys.Init(FVector::OneVector, OutPayload.NumKeys);
+  OutPayload.ConvertSeconds = FPlatformTime::Seconds() - StartTime;
+  return true;
+}
+
+// Builds the single-triangle preview mesh for a skeleton. Runs once per
+// skeleton, later imports reuse it through the skeleton's preview mesh.
+static USkeletalMesh *BuildPreviewMesh(USkeleton *Skeleton,
+                                       const FReferenceSkeleton &LocalRefSkeleton,
+                                       const FString &FolderPath,
+                                       const FString &MeshName,
+                                       EObjectFlags Flags) {
+  BVH_SCOPE_CYCLE_COUNTER(STAT_BVHMeshBuild);
+  UE_LOG(LogBVHImporter, Verbose,
+         TEXT("BVHFactory: Creating Skeletal Mesh..."));
+  FString MeshPackageName = FPaths::Combine(FolderPath, MeshName);
+  UPackage *MeshPackage = CreatePackage(*MeshPackageName);
+  USkeletalMesh *SkeletalMesh = NewObject<USkeletalMesh>(
+      MeshPackage, FName(*MeshName),
+      Flags | RF_Public | RF_Standalone | RF_Transactional);
+
+  SkeletalMesh->SetSkeleton(Skeleton);
+
+  SkeletalMesh->PreEditChange(nullptr);
+
+  // Create a dummy triangle to satisfy engine requirements for skeletal
+  // meshes
+  FSkeletalMeshImportData ImportData;
+  ImportData.Points.Add(FVector3f(0, 0, 0));
+  ImportData.Points.Add(FVector3f(0, 1, 0));
+  ImportData.Points.Add(FVector3f(0, 0, 1));
+  SkeletalMeshImportData::FVertex V0, V1, V2;
+  V0.VertexIndex = 0;
+  V1.VertexIndex = 1;
+  V2.VertexIndex = 2;
+  V0.MatIndex = 0;
+  V1.MatIndex = 0;
+  V2.MatIndex = 0;
+  V0.UVs[0] = FVector2f(0, 0);
+  V1.UVs[0] = FVector2f(1, 0);
+  V2.UVs[0] = FVector2f(0, 1);
+
+  ImportData.Wedges.Add(V0);
+  ImportData.Wedges.Add(V1);
+  ImportData.Wedges.Add(V2);
+
+  SkeletalMeshImportData::FTriangle Tri;
+  Tri.WedgeIndex[0] = 0;
+  Tri.WedgeIndex[1] = 1;
+  Tri.WedgeIndex[2] = 2;
+  Tri.MatIndex = 0;
+  Tri.AuxMatIndex = 0;
+  Tri.SmoothingGroups = 1; // Use 1 for smoothing
+  Tri.TangentZ[0] = FVector3f(0, 0, 1);
+  Tri.TangentZ[1] = FVector3f(0, 0, 1);
+  Tri.TangentZ[2] = FVector3f(0, 0, 1);
+  Tri.TangentX[0] = FVector3f(1, 0, 0);
+  Tri.TangentX[1] = FVector3f(1, 0, 0);
+  Tri.TangentX[2] = FVector3f(1, 0, 0);
+  Tri.TangentY[0] = FVector3f(0, 1, 0);
+  Tri.TangentY[1] = FVector3f(0, 1, 0);
+  Tri.TangentY[2] = FVector3f(0, 1, 0);
+
+  ImportData.Faces.Add(Tri);
+
+  // Add Influences (Bind all to root bone 0)
+  for (int32 i = 0; i < 3; ++i) {
+    SkeletalMeshImportData::FRawBoneInfluence Influence;
+    Influence.VertexIndex = i;
+    Influence.BoneIndex = 0;
+    Influence.Weight = 1.0f;
+    ImportData.Influences.Add(Influence);
+    ImportData.PointToRawMap.Add(i);
+  }
+
+  SkeletalMeshImportData::FMaterial Mat;
+  Mat.MaterialImportName = TEXT("DummyMat");
+  ImportData.Materials.Add(Mat);
+
+  // Populate RefBonesBinary from Skeleton
+  const TArray<FMeshBoneInfo> &RefBoneInfos =
+      LocalRefSkeleton.GetRefBoneInfo();
+  const TArray<FTransform> &RefBonePose = LocalRefSkeleton.GetRefBonePose();
+
+  for (int32 i = 0; i < RefBoneInfos.Num(); ++i) {
+    SkeletalMeshImportData::FBone Bone;
+    Bone.Name = RefBoneInfos[i].Name.ToString();
+    Bone.Flags = 0;
+    Bone.ParentIndex = RefBoneInfos[i].ParentIndex;
+    Bone.NumChildren = 0; // Will calculate below
+
+    FTransform BoneTransform = RefBonePose[i];
+    Bone.BonePos.Transform = FTransform3f(BoneTransform);
+    Bone.BonePos.Length = 1.0f;
+    Bone.BonePos.XSize = 1.0f;
+    Bone.BonePos.YSize = 1.0f;
+    Bone.BonePos.ZSize = 1.0f;
+
+    ImportData.RefBonesBinary.Add(Bone);
+  }
+
+  // Calculate NumChildren
+  for (int32 i = 0; i < ImportData.RefBonesBinary.Num(); ++i) {
+    int32 ParentIdx = ImportData.RefBonesBinary[i].ParentIndex;
+    if (ParentIdx != INDEX_NONE &&
+        ParentIdx < ImportData.RefBonesBinary.Num()) {
+      ImportData.RefBonesBinary[ParentIdx].NumChildren++;
+    }
+  }
+
+  // Finalize Skeleton and Mesh
+  SkeletalMesh->SetRefSkeleton(LocalRefSkeleton);
+  SkeletalMesh->CalculateInvRefMatrices();
+
+  // Sync Skeleton with SkeletalMesh
+  if (Skeleton->MergeAllBonesToBoneTree(SkeletalMesh)) {
+    UE_LOG(LogBVHImporter, Verbose,
+           TEXT("BVHFactory: Merged bones to Skeleton successfully."));
+  } else {
+    UE_LOG(LogBVHImporter, Warning,
+           TEXT("BVHFactory: MergeAllBonesToBoneTree returned false."));
+  }
+
+  FSkeletalMeshLODInfo &LODInfo = SkeletalMesh->AddLODInfo();
+  LODInfo.ScreenSize.Default = 1.0f;
+  LODInfo.LODHysteresis = 0.02f;
+  LODInfo.bAllowCPUAccess = true;
+
+  // Add Default Material
+  FSkeletalMaterial MeshMaterial;
+  MeshMaterial.MaterialInterface = UMaterial::GetDefaultMaterial(MD_Surface);
+  MeshMaterial.MaterialSlotName = TEXT("DummyMat");
+  MeshMaterial.ImportedMaterialSlotName = TEXT("DummyMat");
+  SkeletalMesh->GetMaterials().Add(MeshMaterial);
+
+  // Ensure ImportedModel has an LODModel for LOD 0
+  if (SkeletalMesh->GetImportedModel()) {
+    if (SkeletalMesh->GetImportedModel()->LODModels.Num() == 0) {
+      SkeletalMesh->GetImportedModel()->LODModels.Add(
+          new FSkeletalMeshLODModel());
+    }
+  } else {
+    UE_LOG(LogBVHImporter, Error,
+           TEXT("BVHFactory: SkeletalMesh has no ImportedModel!"));
+  }
+
+  // Migrate to MeshDescription
+  FMeshDescription MeshDescription;
+  FSkeletalMeshAttributes MeshAttributes(MeshDescription);
+  MeshAttributes.Register();
+
+  // Build Mesh
+  IMeshUtilities &MeshUtilities =
+      FModuleManager::Get().LoadModuleChecked<IMeshUtilities>(
+          "MeshUtilities");
+
+  // Convert ImportData to MeshDescription
+  // Use ImportData.GetMeshDescription instead of MeshUtilities
+  ImportData.GetMeshDescription(SkeletalMesh, &LODInfo.BuildSettings,
+                                MeshDescription);
+
+  UE_LOG(LogBVHImporter, Verbose,
+         TEXT("BVHFactory: MeshDescription Stats: Vertices=%d, Polygons=%d"),
+         MeshDescription.Vertices().Num(), MeshDescription.Polygons().Num());
+
+  // Calculate Bounds
+  FBox3f FloatBox(ImportData.Points);
+  FBox BoundingBox(FloatBox);
+  SkeletalMesh->SetImportedBounds(FBoxSphereBounds(BoundingBox));
+
+  // Commit to SkeletalMesh
+  SkeletalMesh->CreateMeshDescription(0, MoveTemp(MeshDescription));
+  SkeletalMesh->CommitMeshDescription(0);
+
+  // Explicitly build the LODModel using MeshUtilities to ensure RenderData
+  // can be generated
+  if (SkeletalMesh->GetImportedModel() &&
+      SkeletalMesh->GetImportedModel()->LODModels.Num() > 0) {
+    UE_LOG(
+        LogBVHImporter, Verbose,
+        TEXT("BVHFactory: ImportData Stats: Points=%d, Wedges=%d, Faces=%d, "
+             "Influences=%d"),
+        ImportData.Points.Num(), ImportData.Wedges.Num(),
+        ImportData.Faces.Num(), ImportData.Influences.Num());
+
+    FSkeletalMeshLODModel &LODModel =
+        SkeletalMesh->GetImportedModel()->LODModels[0];
+    IMeshUtilities::MeshBuildOptions BuildOptions;
+    BuildOptions.FillOptions(LODInfo.BuildSettings);
+
+    // Convert ImportData types to BuildSkeletalMesh types
+    TArray<SkeletalMeshImportData::FVertInfluence> Influences;
+    Influences.Reserve(ImportData.Influences.Num());
+    for (const auto &RawInfluence : ImportData.Influences) {
+      SkeletalMeshImportData::FVertInfluence Influence;
+      Influence.Weight = RawInfluence.Weight;
+      Influence.VertIndex = RawInfluence.VertexIndex;
+      Influence.BoneIndex = RawInfluence.BoneIndex;
+      Influences.Add(Influence);
+    }
+
+    TArray<SkeletalMeshImportData::FMeshWedge> Wedges;
+    Wedges.Reserve(ImportData.Wedges.Num());
+    for (const auto &RawWedge : ImportData.Wedges) {
+      SkeletalMeshImportData::FMeshWedge Wedge;
+      Wedge.iVertex = RawWedge.VertexIndex;
+      for (int32 i = 0; i < MAX_TEXCOORDS; ++i) {
+        Wedge.UVs[i] = RawWedge.UVs[i];
+      }
+      Wedge.Color = RawWedge.Color;
+      Wedges.Add(Wedge);
+    }
+
+    TArray<SkeletalMeshImportData::FMeshFace> Faces;
+    Faces.Reserve(ImportData.Faces.Num());
+    for (const auto &RawFace : ImportData.Faces) {
+      SkeletalMeshImportData::FMeshFace Face;
+      Face.iWedge[0] = RawFace.WedgeIndex[0];
+      Face.iWedge[1] = RawFace.WedgeIndex[1];
+      Face.iWedge[2] = RawFace.WedgeIndex[2];
+      Face.MeshMaterialIndex = RawFace.MatIndex;
+      Face.SmoothingGroups = RawFace.SmoothingGroups;
+      for (int32 i = 0; i < 3; ++i) {
+        Face.TangentX[i] = RawFace.TangentX[i];
+        Face.TangentY[i] = RawFace.TangentY[i];
+        Face.TangentZ[i] = RawFace.TangentZ[i];
+      }
+      Faces.Add(Face);
+    }
+
+    bool bBuildSuccess = MeshUtilities.BuildSkeletalMesh(
+        LODModel, SkeletalMesh->GetName(), SkeletalMesh->GetRefSkeleton(),
+        Influences, Wedges, Faces, ImportData.Points,
+        ImportData.PointToRawMap, BuildOptions);
+
+    if (bBuildSuccess) {
+      UE_LOG(LogBVHImporter, Verbose,
+             TEXT("BVHFactory: BuildSkeletalMesh successful."));
+    } else {
+      UE_LOG(LogBVHImporter, Error,
+             TEXT("BVHFactory: BuildSkeletalMesh failed!"));
+    }
+  }
+
+  if (SkeletalMesh->GetImportedModel() &&
+      SkeletalMesh->GetImportedModel()->LODModels.Num() > 0) {
+    UE_LOG(LogBVHImporter, Verbose,
+           TEXT("BVHFactory: ImportedModel created successfully. LODModels "
+                "count: %d"),
+           SkeletalMesh->GetImportedModel()->LODModels.Num());
+  } else {
+    UE_LOG(LogBVHImporter, Error,
+           TEXT("BVHFactory: ImportedModel is invalid or has no LODModels "
+                "after CommitMeshDescription!"));
+  }
+
+  Skeleton->SetPreviewMesh(SkeletalMesh);
+
+  // Kicks off the render data build on the asset compiler instead of waiting
+  // for it here
+  SkeletalMesh->PostEditChange();
+  SkeletalMesh->CalculateExtendedBounds();
+
+  Skeleton->PostEditChange();
+
+  FAssetRegistryModule::AssetCreated(SkeletalMesh);
+
+  return SkeletalMesh;
+}
+
+USkeleton *ResolveSkeleton(const FBVHImportPayload &Payload,
+                           const FString &FolderPath, FName InName,
+                           EObjectFlags Flags,
+                           USkeletalMesh *&OutPreviewMesh) {
+  BVH_SCOPE_CYCLE_COUNTER(STAT_BVHSkeletonResolve);
+  USkeleton *Skeleton = nullptr;
+  USkeletalMesh *SkeletalMesh = nullptr;
+  bool bSkeletonCreated = false;
+  const FBVHData &Data = Payload.Data;
+
+  // Check for existing Skeleton in the target folder
+  TArray<FName, TInlineAllocator<128>> BoneNames;
+  for (const FBVHBoneTrack &Track : Payload.Tracks) {
+    BoneNames.Add(Track.BoneName);
+  }
+
+  FBVHImporterModule &ImporterModule = FBVHImporterModule::Get();
+  Skeleton =
+      ImporterModule.FindSkeleton(FolderPath, Payload.HierarchyHash, BoneNames);
+  if (Skeleton) {
+    UE_LOG(LogBVHImporter, Verbose,
+           TEXT("BVHFactory: Found existing Skeleton: %s. Reusing it."),
+           *Skeleton->GetName());
+  }
+
+  if (!Skeleton) {
+    // 1. Create Skeleton
+    UE_LOG(LogBVHImporter, Verbose, TEXT("BVHFactory: Creating Skeleton..."));
+    FString SkeletonName = InName.ToString() + TEXT("_Skeleton");
+    FString SkeletonPackageName = FPaths::Combine(FolderPath, SkeletonName);
+    UPackage *SkeletonPackage = CreatePackage(*SkeletonPackageName);
+    Skeleton = NewObject<USkeleton>(SkeletonPackage, FName(*SkeletonName),
+                                    Flags | RF_Public | RF_Standalone |
+                                        RF_Transactional);
+    bSkeletonCreated = true;
+  }
+  // Build Reference Skeleton locally first
+  FReferenceSkeleton LocalRefSkeleton;
+  {
+    FReferenceSkeletonModifier Modifier(LocalRefSkeleton, nullptr);
+
+    UE_LOG(LogBVHImporter, Verbose,
+           TEXT("BVHFactory: Building Skeleton Hierarchy..."));
+    const int32 NumBones = BuildSkeletonHierarchy(Data, Modifier);
+    UE_LOG(LogBVHImporter, Verbose,
+           TEXT("BVHFactory: Hierarchy built. Bone count: %d"), NumBones);
+  }
+
+  UE_LOG(LogBVHImporter, Verbose,
+         TEXT("BVHFactory: LocalRefSkeleton bone count: %d"),
+         LocalRefSkeleton.GetNum());
+  if (LocalRefSkeleton.GetNum() == 0) {
+    UE_LOG(LogBVHImporter, Error,
+           TEXT("BVHFactory: LocalRefSkeleton is empty!"));
+    return nullptr;
+  }
+
+  if (bSkeletonCreated) {
+    // 2. Create Skeletal Mesh (Dummy)
+    SkeletalMesh = BuildPreviewMesh(Skeleton, LocalRefSkeleton, FolderPath,
+                                    InName.ToString() + TEXT("_Mesh"), Flags);
+
+    FAssetRegistryModule::AssetCreated(Skeleton);
+
+    ImporterModule.RegisterSkeleton(FolderPath, Payload.HierarchyHash,
+                                    Skeleton);
+  } else {
+    // Reuse the skeleton's preview mesh, building one only if it never had one
+    SkeletalMesh = Skeleton->GetPreviewMesh();
+    if (!SkeletalMesh) {
+      SkeletalMesh = BuildPreviewMesh(
+          Skeleton, Skeleton->GetReferenceSkeleton(),
+          FPaths::GetPath(Skeleton->GetPathName()),
+          Skeleton->GetName() + TEXT("_Mesh"), Flags);
+      Skeleton->MarkPackageDirty();
+    }
+  }
+
+  OutPreviewMesh = SkeletalMesh;
+  return Skeleton;
+}
+
+// Flags the payload's tracks whose joint exists on Skeleton, through the
+// cached per-skeleton table instead of a name lookup per bone
+static TBitArray<> FindTracksOnSkeleton(const FBVHImportPayload &Payload,
+                                        const FBVHImportOptions &Options,
+                                        const USkeleton *Skeleton) {
+  if (!Skeleton || !Payload.BoneMapping) {
+    return TBitArray<>(true, Payload.Tracks.Num());
+  }
+
+  const TSharedRef<const FBVHBoneMapping> SkeletonMapping =
+      GetBoneMappingCache().FindOrBuild(Payload.Data, Payload.HierarchyHash,
+                                        Options, Skeleton);
+  TBitArray<> TracksOnSkeleton(false, Payload.Tracks.Num());
+  for (int32 TrackIndex = 0; TrackIndex < Payload.Tracks.Num(); ++TrackIndex) {
+    const int32 NodeIndex = Payload.BoneMapping->TrackNodes[TrackIndex];
+    TracksOnSkeleton[TrackIndex] =
+        SkeletonMapping->NodeBones[NodeIndex] != INDEX_NONE;
+  }
+  return TracksOnSkeleton;
+}
+
+// Full tracks share the payload's scaling keys, collapsed constant tracks get
+// the single key
+static void SetTrackKeys(IAnimationDataController &Controller,
+                         const FBVHImportPayload &Payload,
+                         const FBVHBoneTrack &Track, bool bShouldTransact) {
+  static const TArray<FVector> ConstantScalingKeys = {FVector::OneVector};
+  const TArray<FVector> &ScalingKeys =
+      Track.PositionalKeys.Num() == Payload.ScalingKeys.Num()
+          ? Payload.ScalingKeys
+          : ConstantScalingKeys;
+  Controller.SetBoneTrackKeys(Track.BoneName, Track.PositionalKeys,
+                              Track.RotationalKeys, ScalingKeys,
+                              bShouldTransact);
+}
+
+// Stores the source path and what this import wrote on the sequence, for the
+// next reimport to diff against
+static void RecordImport(const FBVHImportPayload &Payload,
+                         UAnimSequence *AnimSequence,
+                         const FBVHImportOptions &Options) {
+  UBVHImportUserData *UserData =
+      AnimSequence->GetAssetUserData<UBVHImportUserData>();
+  if (!UserData) {
+    UserData = NewObject<UBVHImportUserData>(AnimSequence, NAME_None,
+                                             RF_Transactional);
+    AnimSequence->AddAssetUserData(UserData);
+  } else if (Options.bTransactional) {
+    UserData->Modify();
+  }
+
+  UserData->HierarchyHash = Payload.HierarchyHash;
+  UserData->FrameRate = Payload.FrameRate;
+  UserData->NumKeys = Payload.NumKeys;
+  UserData->SourceHashes.Reset();
+  for (int32 TrackIndex = 0; TrackIndex < Payload.Tracks.Num(); ++TrackIndex) {
+    UserData->SourceHashes.Add(Payload.Tracks[TrackIndex].BoneName,
+                               Payload.SourceHashes[TrackIndex]);
+  }
+
+  // Recorded as requested rather than as resolved, so a reimport following
+  // the project's default rate picks up a changed default
+  UserData->TargetFrameRate = Options.TargetFrameRate;
+  UserData->bKeepSourceFrameRate = Options.bKeepSourceFrameRate;
+  UserData->bReduceConstantTracks = Options.bReduceConstantTracks;
+  UserData->ConstantPositionTolerance = Options.ConstantPositionTolerance;
+  UserData->ConstantRotationTolerance = Options.ConstantRotationTolerance;
+  UserData->FirstFrame = Options.FirstFrame;
+  UserData->NumFrames = Options.NumFrames;
+  UserData->FrameStride = Options.FrameStride;
+  UserData->IncludeBones = Options.IncludeBones;
+  UserData->ExcludeBones = Options.ExcludeBones;
+  UserData->bExcludeEndSites = Options.bExcludeEndSites;
+
+  if (AnimSequence->AssetImportData) {
+    AnimSequence->AssetImportData->Update(Payload.Filename);
+  }
+}
+
+bool RestoreImportOptions(const UAnimSequence *AnimSequence,
+                          FBVHImportOptions &Options) {
+  const UBVHImportUserData *UserData =
+      AnimSequence ? AnimSequence->GetAssetUserData<UBVHImportUserData>()
+                   : nullptr;
+  if (!UserData) {
+    return false;
+  }
+
+  Options.TargetFrameRate = UserData->TargetFrameRate;
+  Options.bKeepSourceFrameRate = UserData->bKeepSourceFrameRate;
+  Options.bReduceConstantTracks = UserData->bReduceConstantTracks;
+  Options.ConstantPositionTolerance = UserData->ConstantPositionTolerance;
+  Options.ConstantRotationTolerance = UserData->ConstantRotationTolerance;
+  Options.FirstFrame = UserData->FirstFrame;
+  Options.NumFrames = UserData->NumFrames;
+  Options.FrameStride = UserData->FrameStride;
+  Options.IncludeBones = UserData->IncludeBones;
+  Options.ExcludeBones = UserData->ExcludeBones;
+  Options.bExcludeEndSites = UserData->bExcludeEndSites;
+
+  // Only tracks the sequence still holds can be left unconverted
+  Options.PreviousSourceHashes.Reset();
+  if (const IAnimationDataModel *Model = AnimSequence->GetDataModel()) {
+    for (const TPair<FName, uint64> &Stored : UserData->SourceHashes) {
+      if (Model->IsValidBoneTrackName(Stored.Key)) {
+        Options.PreviousSourceHashes.Add(Stored.Key, Stored.Value);
+      }
+    }
+  }
+  return true;
+}
+
+UAnimSequence *CreateAnimSequence(const FBVHImportPayload &Payload,
+                                  UObject *InParent, FName InName,
+                                  EObjectFlags Flags, USkeleton *Skeleton,
+                                  USkeletalMesh *PreviewMesh,
+                                  const FBVHImportOptions &Options) {
+  const bool bShouldTransact = Options.bTransactional;
+  const double StartTime = FPlatformTime::Seconds();
+
+  // 3. Create AnimSequence
+  UE_LOG(LogBVHImporter, Verbose, TEXT("BVHFactory: Creating AnimSequence..."));
+  UAnimSequence *AnimSequence = NewObject<UAnimSequence>(
+      InParent, InName, Flags | RF_Public | RF_Standalone | RF_Transactional);
+  AnimSequence->SetSkeleton(Skeleton);
+  AnimSequence->SetPreviewMesh(PreviewMesh);
+
+  IAnimationDataController &Controller = AnimSequence->GetController();
+
+  // Initialize the data model (creates MovieScene etc.)
+  Controller.InitializeModel();
+
+  // One bracket around the whole population, so listeners see a single model
+  // update instead of one per bone
+  BVH_SCOPE_CYCLE_COUNTER(STAT_BVHControllerCommit);
+  Controller.OpenBracket(LOCTEXT("ImportBVH", "Importing BVH"),
+                         bShouldTransact);
+
+  // Reset NumberOfFrames to 0 to avoid incompatible resampling errors when
+  // changing FrameRate InitializeModel() might create a default sequence with
+  // non-zero length at default FrameRate (30fps).
+
+  // The tracks were resampled to Payload.FrameRate, N keys span N - 1 frames
+  Controller.SetNumberOfFrames(FFrameNumber(0), bShouldTransact);
+  Controller.SetFrameRate(Payload.FrameRate, bShouldTransact);
+  Controller.SetNumberOfFrames(FFrameNumber(FMath::Max(Payload.NumKeys - 1, 1)),
+                               bShouldTransact);
+
+  // Populate Animation Data using AnimationBlueprintLibrary
+  // This handles the data model initialization and curve creation more robustly
+  const TBitArray<> TracksOnSkeleton =
+      FindTracksOnSkeleton(Payload, Options, Skeleton);
+  for (int32 TrackIndex = 0; TrackIndex < Payload.Tracks.Num(); ++TrackIndex) {
+    if (TracksOnSkeleton[TrackIndex]) {
+      const FBVHBoneTrack &Track = Payload.Tracks[TrackIndex];
+      Controller.AddBoneCurve(Track.BoneName, bShouldTransact);
+      SetTrackKeys(Controller, Payload, Track, bShouldTransact);
+    }
+  }
+
+  Controller.NotifyPopulated();
+  Controller.CloseBracket(bShouldTransact);
+
+  RecordImport(Payload, AnimSequence, Options);
+  AnimSequence->PostEditChange();
+
+  // Notify Asset Registry
+  FAssetRegistryModule::AssetCreated(AnimSequence);
+
+  // One line per import, detail lines above are Verbose
+  const double ConvertSeconds =
+      FMath::Max(Payload.ConvertSeconds, UE_SMALL_NUMBER);
+  UE_LOG(LogBVHImporter, Log,
+         TEXT("BVHImporter: %s: %d frames, %d bones, %d keys at %s. Parse and "
+              "convert %.1f ms (%.0f frames/s, %.1f MB/s), commit %.1f ms, "
+              "%.2f MB allocated."),
+         *FPaths::GetCleanFilename(Payload.Filename), Payload.Data.NumFrames,
+         Payload.Tracks.Num(), Payload.NumKeys,
+         *Payload.FrameRate.ToPrettyText().ToString(), ConvertSeconds * 1000.0,
+         Payload.Data.NumFrames / ConvertSeconds,
+         Payload.FileSize / 1e6 / ConvertSeconds,
+         (FPlatformTime::Seconds() - StartTime) * 1000.0,
+         Payload.GetAllocatedSize() / 1e6);
+
+  return AnimSequence;
+}
+
+bool UpdateAnimSequence(const FBVHImportPayload &Payload,
+                        UAnimSequence *AnimSequence,
+                        const FBVHImportOptions &Options) {
+  const bool bShouldTransact = Options.bTransactional;
+  const double StartTime = FPlatformTime::Seconds();
+
+  // The hierarchy hash covers names and tree shape, so a match means every
+  // track still maps onto a bone of the sequence's skeleton
+  const UBVHImportUserData *UserData =
+      AnimSequence->GetAssetUserData<UBVHImportUserData>();
+  if (!UserData || UserData->HierarchyHash != Payload.HierarchyHash) {
+    UE_LOG(LogBVHImporter, Warning,
+           TEXT("BVHImporter: The hierarchy of %s no longer matches %s, "
+                "import it as a new asset instead"),
+           *FPaths::GetCleanFilename(Payload.Filename),
+           *AnimSequence->GetName());
+    return false;
+  }
+
+  const TBitArray<> TracksOnSkeleton =
+      FindTracksOnSkeleton(Payload, Options, AnimSequence->GetSkeleton());
+
+  // A new length or rate resamples every track in the model, so all of them
+  // are rewritten. It also changes every source hash, so all were converted.
+  const bool bTimingChanged = UserData->NumKeys != Payload.NumKeys ||
+                              UserData->FrameRate != Payload.FrameRate;
+
+  IAnimationDataController &Controller = AnimSequence->GetController();
+  const IAnimationDataModel *Model = AnimSequence->GetDataModel();
+  int32 NumUpdated = 0;
+  int32 NumRemoved = 0;
+  {
+    BVH_SCOPE_CYCLE_COUNTER(STAT_BVHControllerCommit);
+    Controller.OpenBracket(LOCTEXT("ReimportBVH", "Reimporting BVH"),
+                           bShouldTransact);
+    if (bTimingChanged) {
+      Controller.SetNumberOfFrames(FFrameNumber(0), bShouldTransact);
+      Controller.SetFrameRate(Payload.FrameRate, bShouldTransact);
+      Controller.SetNumberOfFrames(
+          FFrameNumber(FMath::Max(Payload.NumKeys - 1, 1)), bShouldTransact);
+    }
+
+    TSet<FName> ProducedBones;
+    ProducedBones.Reserve(Payload.Tracks.Num());
+    for (int32 TrackIndex = 0; TrackIndex < Payload.Tracks.Num();
+         ++TrackIndex) {
+      if (!TracksOnSkeleton[TrackIndex]) {
+        continue;
+      }
+
+      const FBVHBoneTrack &Track = Payload.Tracks[TrackIndex];
+      ProducedBones.Add(Track.BoneName);
+      // Unchanged tracks were only offered for bones the sequence still has
+      // and hold no keys
+      if (!bTimingChanged && Payload.UnchangedTracks[TrackIndex]) {
+        continue;
+      }
+
+      if (!Model->IsValidBoneTrackName(Track.BoneName)) {
+        Controller.AddBoneCurve(Track.BoneName, bShouldTransact);
+      }
+      SetTrackKeys(Controller, Payload, Track, bShouldTransact);
+      ++NumUpdated;
+    }
+
+    // Tracks the previous import wrote that this one no longer produces, such
+    // as joints the source dropped or the joint filter now excludes. Their
+    // hashes go with the record below.
+    for (const TPair<FName, uint64> &Stored : UserData->SourceHashes) {
+      if (!ProducedBones.Contains(Stored.Key) &&
+          Model->IsValidBoneTrackName(Stored.Key)) {
+        Controller.RemoveBoneTrack(Stored.Key, bShouldTransact);
+        ++NumRemoved;
+      }
+    }
+
+    // Recorded inside the bracket, so one undo restores the tracks and the
+    // hashes they were written from
+    RecordImport(Payload, AnimSequence, Options);
+    Controller.CloseBracket(bShouldTransact);
+  }
+
+  AnimSequence->PostEditChange();
+  AnimSequence->MarkPackageDirty();
+
+  UE_LOG(LogBVHImporter, Log,
+         TEXT("BVHImporter: Reimported %s: %d of %d tracks changed, %d "
+              "removed, commit %.1f ms."),
+         *FPaths::GetCleanFilename(Payload.Filename), NumUpdated,
+         Payload.Tracks.Num(), NumRemoved,
+         (FPlatformTime::Seconds() - StartTime) * 1000.0);
+  return true;
+}
+
+TArray<UAnimSequence *> ImportFiles(const TArray<FString> &Filenames,
+                                    const FString &DestinationPath,
+                                    const FBVHImportOptions &Options,
+                                    EObjectFlags Flags) {
+  check(IsInGameThread());
+
+  TArray<UAnimSequence *> Imported;
+  if (Filenames.Num() == 0) {
+    return Imported;
+  }
+
+  IAssetTools &AssetTools =
+      FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools").Get();
+
+  // Workers poll the token between chunks, so a cancel stops the window in
+  // flight instead of waiting out whole files
+  FBVHImportProgress LocalProgress;
+  FBVHImportOptions BatchOptions = Options;
+  if (!BatchOptions.Progress) {
+    BatchOptions.Progress = &LocalProgress;
+  }
+  FBVHImportProgress &Progress = *BatchOptions.Progress;
+
+  FScopedSlowTask SlowTask(
+      Filenames.Num(),
+      FText::Format(LOCTEXT("ImportingFiles", "Importing {0} BVH files"),
+                    Filenames.Num()));
+  SlowTask.MakeDialog(/*bShowCancelButton=*/true);
+
+  // Workers convert one window ahead of the game thread, so memory is bounded
+  // by two windows of payloads rather than by the whole batch
+  const int32 WindowSize =
+      FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads()) * 2;
+  TArray<FBVHImportPayload> Windows[2];
+
+  auto LaunchWindow = [&Filenames, &Windows, &BatchOptions,
+                       WindowSize](int32 Slot, int32 First) {
+    TArray<FBVHImportPayload> &Window = Windows[Slot];
+    // Payloads are recycled from the window before last, so their key buffers
+    // and scratch arenas carry over instead of being reallocated per file
+    Window.SetNum(FMath::Min(WindowSize, Filenames.Num() - First));
+    return UE::Tasks::Launch(
+        UE_SOURCE_LOCATION, [&Filenames, &Window, &BatchOptions, First]() {
+          ParallelFor(Window.Num(), [&Filenames, &Window, &BatchOptions,
+                                     First](int32 Index) {
+            FBVHImportPayload &Payload = Window[Index];
+            Payload.bParsed = ParseAndConvert(Filenames[First + Index],
+                                              Payload, BatchOptions);
+          });
+        });
+  };
+
+  USkeleton *Skeleton = nullptr;
+  USkeletalMesh *PreviewMesh = nullptr;
+  int32 Slot = 0;
+  UE::Tasks::TTask<void> Pending = LaunchWindow(Slot, 0);
+
+  for (int32 First = 0; First < Filenames.Num(); First += WindowSize) {
+    // Keep the dialog responsive while the window converts
+    while (!Pending.Wait(FTimespan::FromMilliseconds(50))) {
+      SlowTask.TickProgress();
+      if (SlowTask.ShouldCancel()) {
+        Progress.Cancel();
+      }
+    }
+    if (Progress.IsCancelled()) {
+      break;
+    }
+
+    // The next window starts once the shared skeleton is known, so it only
+    // converts the joints the skeleton has
+    bool bNextLaunched = First + WindowSize >= Filenames.Num();
+    auto LaunchNextWindow = [&]() {
+      if (!bNextLaunched) {
+        BatchOptions.TargetSkeleton = Skeleton;
+        Pending = LaunchWindow(1 - Slot, First + WindowSize);
+        bNextLaunched = true;
+      }
+    };
+
+    for (const FBVHImportPayload &Payload : Windows[Slot]) {
+      SlowTask.EnterProgressFrame(
+          1.0f, FText::Format(LOCTEXT("ImportingFile", "Importing {0}"),
+                              FText::FromString(
+                                  FPaths::GetCleanFilename(Payload.Filename))));
+      if (SlowTask.ShouldCancel()) {
+        Progress.Cancel();
+      }
+      if (Progress.IsCancelled()) {
+        break;
+      }
+
+      if (!Payload.bParsed) {
+        UE_LOG(LogBVHImporter, Error, TEXT("BVHFactory: Skipping %s."),
+               *Payload.Filename);
+        continue;
+      }
+
+      FString PackageName;
+      FString AssetName;
+      AssetTools.CreateUniqueAssetName(
+          FPaths::Combine(DestinationPath,
+                          ObjectTools::SanitizeObjectName(
+                              FPaths::GetBaseFilename(Payload.Filename))),
+          TEXT(""), PackageName, AssetName);
+
+      // The skeleton is resolved once and shared by the whole batch, before
+      // the animation's package exists so a failure leaves no empty package
+      if (!Skeleton) {
+        Skeleton = ResolveSkeleton(Payload, FPaths::GetPath(PackageName),
+                                   FName(*AssetName), Flags, PreviewMesh);
+        if (!Skeleton) {
+          continue;
+        }
+      }
+      LaunchNextWindow();
+
+      UPackage *Package = CreatePackage(*PackageName);
+      if (UAnimSequence *AnimSequence =
+              CreateAnimSequence(Payload, Package, FName(*AssetName), Flags,
+                                 Skeleton, PreviewMesh, Options)) {
+        Imported.Add(AnimSequence);
+      } else {
+        // Nothing refers to the package yet, so it goes with the next GC
+        Package->ClearFlags(RF_Standalone | RF_Public);
+        Package->MarkAsGarbage();
+      }
+    }
+
+    if (!Progress.IsCancelled()) {
+      LaunchNextWindow();
+    }
+    Slot = 1 - Slot;
+  }
+
+  // Workers see the token and bail out of the window in flight
+  Pending.Wait();
+  if (Progress.IsCancelled()) {
+    UE_LOG(LogBVHImporter, Log, TEXT("BVHFactory: Batch import cancelled."));
+  }
+
+  // The batch's skeleton may be edited or collected before the next one
+  GetBoneMappingCache().Reset();
+
+  UE_LOG(LogBVHImporter, Log,
+         TEXT("BVHFactory: Batch imported %d of %d files."), Imported.Num(),
+         Filenames.Num());
+  return Imported;
+}
+
+} // namespace BVHImportPipeline
+
+#undef LOCTEXT_NAMESPACE
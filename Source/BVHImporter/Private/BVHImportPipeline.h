@@ -0,0 +1,233 @@
+#pragma once
+
+#include "BVHParser.h"
+#include "CoreMinimal.h"
+#include "Misc/FrameRate.h"
+#include <atomic>
+
+class UAnimSequence;
+class USkeletalMesh;
+class USkeleton;
+
+// Converted UE-space keys for one bone. Scaling is always one, so the keys
+// live once in the payload instead of per bone.
+struct FBVHBoneTrack {
+  FName BoneName;
+  TArray<FVector> PositionalKeys;
+  TArray<FQuat> RotationalKeys;
+};
+
+// Which joints of a hierarchy an import converts. Computed once per hierarchy,
+// joint filter and target skeleton and shared by every file matching them.
+struct FBVHBoneMapping {
+  // FBVHData::Nodes index of each converted track, in track order
+  TArray<int32> TrackNodes;
+
+  // Skeleton bone index per node, INDEX_NONE for joints the skeleton lacks.
+  // Empty when the mapping was built without a skeleton.
+  TArray<int32> NodeBones;
+
+  // Hash of TrackNodes, so cached tracks are only reused for the same subset
+  uint32 TrackSignature = 0;
+};
+
+// Per-worker buffers the conversion stages write through, reused across files
+struct FBVHScratchBuffers {
+  TArray<FVector> Positions;
+  TArray<FQuat> Rotations;
+};
+
+// Shared between an import running on worker threads and the thread showing
+// its progress. Frame counts grow as headers are parsed and chunks convert,
+// cancellation is polled between stages and chunks.
+struct FBVHImportProgress {
+  std::atomic<int64> FramesTotal{0};
+  std::atomic<int64> FramesConverted{0};
+  std::atomic<bool> bCancelRequested{false};
+
+  void Cancel() { bCancelRequested.store(true, std::memory_order_relaxed); }
+  bool IsCancelled() const {
+    return bCancelRequested.load(std::memory_order_relaxed);
+  }
+};
+
+// Settings shared by the stages of an import
+struct FBVHImportOptions {
+  // Record the data model edits in the undo buffer. Batch jobs turn this off.
+  bool bTransactional = true;
+
+  // Files at least this large are parsed and converted in chunks instead of
+  // being loaded whole. Zero or less always loads the whole file.
+  int64 StreamingThresholdBytes = 256 * 1024 * 1024;
+
+  // Frames per chunk when streaming
+  int32 StreamingChunkFrames = 4096;
+
+  // Keep a binary copy of each parsed file in Intermediate/BVHCache and read it
+  // back on re-import while the source is unchanged. Streamed files are never
+  // cached.
+  bool bUseBinaryCache = true;
+
+  // Share converted bone tracks through the DerivedDataCache, keyed by motion
+  // content, hierarchy and conversion settings. Streamed files always convert.
+  bool bUseDerivedDataCache = false;
+
+  // Rate the sequence is sampled at. Keys are resampled from the file's Frame
+  // Time. Left invalid, the project's default animation frame rate is used.
+  FFrameRate TargetFrameRate = FFrameRate(0, 0);
+
+  // Keep the file's own rate and emit its frames 1:1 instead of resampling
+  bool bKeepSourceFrameRate = false;
+
+  // Collapse tracks that stay within the tolerances below for the whole take,
+  // such as fingers and end sites, to a single key
+  bool bReduceConstantTracks = false;
+  double ConstantPositionTolerance = 0.001; // Centimeters
+  double ConstantRotationTolerance = 0.01;  // Degrees
+
+  // Frame window: NumFrames source frames from FirstFrame on, keeping every
+  // FrameStride-th. A negative NumFrames runs to the end of the take. Ranged
+  // imports skip the unwanted lines at parse time and bypass both caches,
+  // which only ever hold whole takes.
+  int32 FirstFrame = 0;
+  int32 NumFrames = INDEX_NONE;
+  int32 FrameStride = 1;
+
+  // Joint filter applied before conversion, with * and ? wildcards. An empty
+  // include list keeps every joint, excludes win over includes. Filtered
+  // joints stay in the skeleton but get no track.
+  TArray<FString> IncludeBones;
+  TArray<FString> ExcludeBones;
+  bool bExcludeEndSites = false;
+
+  // Source hashes a previous import recorded for tracks the sequence still
+  // has. A track whose joint hashes the same is not converted again, the
+  // reimport leaves its keys in the sequence.
+  TMap<FName, uint64> PreviousSourceHashes;
+
+  // Skeleton the tracks are meant for when it is known before conversion.
+  // Joints missing from it are never converted.
+  const USkeleton *TargetSkeleton = nullptr;
+
+  // Optional progress and cancellation token. A cancelled import stops before
+  // any UObject is created for the files it has not finished.
+  FBVHImportProgress *Progress = nullptr;
+};
+
+// Everything an import produces before any UObject is touched
+struct FBVHImportPayload {
+  FString Filename;
+  FBVHData Data;
+  uint32 HierarchyHash = 0; // Joint names and tree shape
+  TSharedPtr<const FBVHBoneMapping> BoneMapping; // One node per track
+  TArray<FBVHBoneTrack> Tracks;
+  TArray<uint64> SourceHashes; // Per track, what its keys are converted from
+  TBitArray<> UnchangedTracks; // Hash matches PreviousSourceHashes, no keys
+  TArray<FVector> ScalingKeys; // NumKeys of one, shared by every full track
+  FFrameRate FrameRate;        // Rate the tracks are sampled at
+  int32 NumKeys = 0;           // Keys per track at FrameRate
+  bool bParsed = false;
+
+  // Summary figures of ParseAndConvert
+  int64 FileSize = 0;
+  double ConvertSeconds = 0.0;
+
+  // Scratch arena of the conversion stages
+  TArray<FBVHScratchBuffers> Scratch;
+
+  // Source frames a resample blends and their channel-major motion
+  TArray<int32> SampledFrames;
+  TArray<double> SampledMotion;
+
+  // Drops the previous file's results but keeps the track and scratch buffers,
+  // so a recycled payload converts without allocating per bone
+  void Reset() {
+    Filename.Reset();
+    Data = FBVHData();
+    HierarchyHash = 0;
+    BoneMapping.Reset();
+    for (FBVHBoneTrack &Track : Tracks) {
+      Track.PositionalKeys.Reset();
+      Track.RotationalKeys.Reset();
+    }
+    SourceHashes.Reset();
+    UnchangedTracks.Reset();
+    ScalingKeys.Reset();
+    SampledFrames.Reset();
+    SampledMotion.Reset();
+    FrameRate = FFrameRate();
+    NumKeys = 0;
+    bParsed = false;
+    FileSize = 0;
+    ConvertSeconds = 0.0;
+  }
+
+  // Bytes held by the hierarchy, tracks and scratch arena
+  SIZE_T GetAllocatedSize() const {
+    SIZE_T Size = Data.Nodes.GetAllocatedSize() +
+                  Data.MotionData.GetAllocatedSize() +
+                  Tracks.GetAllocatedSize() + ScalingKeys.GetAllocatedSize() +
+                  Scratch.GetAllocatedSize() +
+                  SampledFrames.GetAllocatedSize() +
+                  SampledMotion.GetAllocatedSize();
+    for (const FBVHBoneTrack &Track : Tracks) {
+      Size += Track.PositionalKeys.GetAllocatedSize() +
+              Track.RotationalKeys.GetAllocatedSize();
+    }
+    for (const FBVHScratchBuffers &Buffers : Scratch) {
+      Size += Buffers.Positions.GetAllocatedSize() +
+              Buffers.Rotations.GetAllocatedSize();
+    }
+    return Size;
+  }
+};
+
+namespace BVHImportPipeline {
+// Parses the file and converts every bone's keys. Touches no UObjects, so it
+// is safe to call from worker threads. Large files are streamed in chunks.
+// Either way OutPayload.Data keeps the hierarchy and frame count, the motion
+// is dropped once it is converted. Returns false when Options.Progress is
+// cancelled before the payload is complete.
+bool ParseAndConvert(const FString &Filename, FBVHImportPayload &OutPayload,
+                     const FBVHImportOptions &Options = FBVHImportOptions());
+
+// Finds a skeleton in FolderPath through the module's skeleton cache or
+// creates one there together with the dummy preview mesh, named after InName.
+// Needs no package for the animation, so a failed resolve leaves none behind.
+// Game thread only.
+USkeleton *ResolveSkeleton(const FBVHImportPayload &Payload,
+                           const FString &FolderPath, FName InName,
+                           EObjectFlags Flags,
+                           USkeletalMesh *&OutPreviewMesh);
+
+// Creates the AnimSequence and commits the converted tracks inside a single
+// controller bracket. Game thread only.
+UAnimSequence *CreateAnimSequence(const FBVHImportPayload &Payload,
+                                  UObject *InParent, FName InName,
+                                  EObjectFlags Flags, USkeleton *Skeleton,
+                                  USkeletalMesh *PreviewMesh,
+                                  const FBVHImportOptions &Options);
+
+// Rewrites only the bone tracks of AnimSequence whose converted keys differ
+// from the hashes the previous import recorded on it. Returns false when the
+// sequence was not imported from BVH or the hierarchy changed, which needs a
+// fresh import against a new skeleton. Game thread only.
+bool UpdateAnimSequence(const FBVHImportPayload &Payload,
+                        UAnimSequence *AnimSequence,
+                        const FBVHImportOptions &Options);
+
+// Copies the options the last import recorded on AnimSequence onto Options,
+// so a reimport converts the edited file the way the original was. Returns
+// false when the sequence was not imported from BVH.
+bool RestoreImportOptions(const UAnimSequence *AnimSequence,
+                          FBVHImportOptions &Options);
+
+// Imports many files into DestinationPath with one shared skeleton. Parsing
+// and conversion run on worker threads, only UObject creation is serialized
+// onto the game thread. Shows per-file progress; cancelling keeps the files
+// already imported and creates no packages for the rest.
+TArray<UAnimSequence *>
+ImportFiles(const TArray<FString> &Filenames, const FString &DestinationPath,
+            const FBVHImportOptions &Options,
+            EObjectFlags Flags = RF_Public | RF_Standalone);
+} // namespace BVHImportPipeline
@@ -0,0 +1,23 @@
+#include "BVHImportSettings.h"
+#include "BVHImportPipeline.h"
+
+UBVHImportSettings::UBVHImportSettings() {
+  CategoryName = TEXT("Plugins");
+  SectionName = TEXT("BVH Importer");
+}
+
+void UBVHImportSettings::ApplyTo(FBVHImportOptions &Options) const {
+  Options.bUseBinaryCache = bUseBinaryCache;
+  Options.bUseDerivedDataCache = bUseDerivedDataCache;
+  Options.TargetFrameRate = TargetFrameRate;
+  Options.bKeepSourceFrameRate = bKeepSourceFrameRate;
+  Options.FirstFrame = FirstFrame;
+  Options.NumFrames = NumFrames;
+  Options.FrameStride = FrameStride;
+  Options.IncludeBones = IncludeBones;
+  Options.ExcludeBones = ExcludeBones;
+  Options.bExcludeEndSites = bExcludeEndSites;
+  Options.bReduceConstantTracks = bReduceConstantTracks;
+  Options.ConstantPositionTolerance = ConstantPositionTolerance;
+  Options.ConstantRotationTolerance = ConstantRotationTolerance;
+}
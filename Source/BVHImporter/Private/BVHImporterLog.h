@@ -0,0 +1,15 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BVHRuntimeLog.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogBVHImporter, Log, All);
+
+/**
+ * Editor import stages, reported next to the runtime parse stages in "stat BVHImporter".
+ * Key conversion covers sampling, resampling and constant track reduction.
+ */
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Skeleton Resolve"), STAT_BVHSkeletonResolve, STATGROUP_BVHImporter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Mesh Build"), STAT_BVHMeshBuild, STATGROUP_BVHImporter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Key Conversion"), STAT_BVHKeyConversion, STATGROUP_BVHImporter, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Controller Commit"), STAT_BVHControllerCommit, STATGROUP_BVHImporter, );
@@ -1,15 +1,196 @@
 #include "BVHImporterModule.h"
+#include "Algo/AllOf.h"
+#include "Animation/Skeleton.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "BVHImportPipeline.h"
+#include "BVHImportSettings.h"
+#include "BVHImporterLog.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/PackageName.h"
 
 #define LOCTEXT_NAMESPACE "FBVHImporterModule"
 
+DEFINE_LOG_CATEGORY(LogBVHImporter);
+
+DEFINE_STAT(STAT_BVHSkeletonResolve);
+DEFINE_STAT(STAT_BVHMeshBuild);
+DEFINE_STAT(STAT_BVHKeyConversion);
+DEFINE_STAT(STAT_BVHControllerCommit);
+
+namespace
+{
+	void ImportDirectory(const TArray<FString>& Args)
+	{
+		if (Args.Num() < 2)
+		{
+			UE_LOG(LogBVHImporter, Warning, TEXT("Usage: BVH.ImportDirectory <SourceDirectory> <DestinationPath>"));
+			return;
+		}
+
+		const FString& SourceDirectory = Args[0];
+		TArray<FString> FoundFiles;
+		IFileManager::Get().FindFiles(FoundFiles, *FPaths::Combine(SourceDirectory, TEXT("*.bvh")), true, false);
+		FoundFiles.Sort();
+
+		TArray<FString> Filenames;
+		Filenames.Reserve(FoundFiles.Num());
+		for (const FString& File : FoundFiles)
+		{
+			Filenames.Add(FPaths::Combine(SourceDirectory, File));
+		}
+
+		// Batch jobs have no use for undo history
+		FBVHImportOptions Options;
+		GetDefault<UBVHImportSettings>()->ApplyTo(Options);
+		Options.bTransactional = false;
+		BVHImportPipeline::ImportFiles(Filenames, Args[1], Options);
+	}
+
+	FAutoConsoleCommand ImportDirectoryCommand(
+		TEXT("BVH.ImportDirectory"),
+		TEXT("Imports every .bvh file in a directory as AnimSequences sharing one skeleton. Usage: BVH.ImportDirectory <SourceDirectory> <DestinationPath>"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&ImportDirectory));
+
+}
+
 void FBVHImporterModule::StartupModule()
 {
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
 
+	// Derived skeleton types resolve imports just like USkeleton. Matching class paths keeps the handlers from
+	// resolving a class for every asset the startup scan adds.
+	SkeletonClassPaths.Reset();
+	AssetRegistry.GetDerivedClassNames({ USkeleton::StaticClass()->GetClassPathName() }, {}, SkeletonClassPaths);
+
+	OnAssetAddedHandle = AssetRegistry.OnAssetAdded().AddRaw(this, &FBVHImporterModule::OnAssetAdded);
+	OnAssetRemovedHandle = AssetRegistry.OnAssetRemoved().AddRaw(this, &FBVHImporterModule::OnAssetRemoved);
+	OnAssetRenamedHandle = AssetRegistry.OnAssetRenamed().AddRaw(this, &FBVHImporterModule::OnAssetRenamed);
 }
 
 void FBVHImporterModule::ShutdownModule()
 {
+	if (FAssetRegistryModule* AssetRegistryModule = FModuleManager::GetModulePtr<FAssetRegistryModule>("AssetRegistry"))
+	{
+		IAssetRegistry& AssetRegistry = AssetRegistryModule->Get();
+		AssetRegistry.OnAssetAdded().Remove(OnAssetAddedHandle);
+		AssetRegistry.OnAssetRemoved().Remove(OnAssetRemovedHandle);
+		AssetRegistry.OnAssetRenamed().Remove(OnAssetRenamedHandle);
+	}
+	SkeletonCache.Empty();
+	SkeletonClassPaths.Empty();
+}
+
+FBVHImporterModule& FBVHImporterModule::Get()
+{
+	return FModuleManager::GetModuleChecked<FBVHImporterModule>("BVHImporter");
+}
+
+USkeleton* FBVHImporterModule::FindSkeleton(const FString& FolderPath, uint32 HierarchyHash, TConstArrayView<FName> BoneNames)
+{
+	const FName FolderName(*FolderPath);
+	const TPair<FName, uint32> Key(FolderName, HierarchyHash);
+	if (const TWeakObjectPtr<USkeleton>* Cached = SkeletonCache.Find(Key))
+	{
+		if (USkeleton* Skeleton = Cached->Get())
+		{
+			return Skeleton;
+		}
+		SkeletonCache.Remove(Key);
+	}
+
+	// Only skeletons directly in the folder, without enumerating the other assets there
+	FARFilter Filter;
+	Filter.PackagePaths.Add(FolderName);
+	Filter.ClassPaths.Add(USkeleton::StaticClass()->GetClassPathName());
+	Filter.bRecursiveClasses = true;
+
+	TArray<FAssetData> SkeletonAssets;
+	FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get().GetAssets(Filter, SkeletonAssets);
+
+	USkeleton* Fallback = nullptr;
+	USkeleton* Match = nullptr;
+	for (const FAssetData& Asset : SkeletonAssets)
+	{
+		USkeleton* Skeleton = Cast<USkeleton>(Asset.GetAsset());
+		if (!Skeleton)
+		{
+			UE_LOG(LogBVHImporter, Warning, TEXT("BVHFactory: Found Skeleton asset but failed to load it: %s"), *Asset.AssetName.ToString());
+			continue;
+		}
+
+		if (!Fallback)
+		{
+			Fallback = Skeleton;
+		}
+
+		const FReferenceSkeleton& RefSkeleton = Skeleton->GetReferenceSkeleton();
+		const bool bContainsAllBones = Algo::AllOf(BoneNames, [&RefSkeleton](FName BoneName)
+		{
+			return RefSkeleton.FindBoneIndex(BoneName) != INDEX_NONE;
+		});
+		if (bContainsAllBones)
+		{
+			Match = Skeleton;
+			break;
+		}
+	}
+
+	// Any skeleton in the folder is reused, as before, but one that fits the hierarchy wins
+	USkeleton* Result = Match ? Match : Fallback;
+	if (Result)
+	{
+		SkeletonCache.Add(Key, Result);
+	}
+	return Result;
+}
+
+void FBVHImporterModule::RegisterSkeleton(const FString& FolderPath, uint32 HierarchyHash, USkeleton* Skeleton)
+{
+	SkeletonCache.Add(TPair<FName, uint32>(FName(*FolderPath), HierarchyHash), Skeleton);
+}
+
+void FBVHImporterModule::OnAssetAdded(const FAssetData& AssetData)
+{
+	if (IsSkeletonAsset(AssetData))
+	{
+		InvalidateFolder(AssetData.PackagePath);
+	}
+}
+
+void FBVHImporterModule::OnAssetRemoved(const FAssetData& AssetData)
+{
+	if (IsSkeletonAsset(AssetData))
+	{
+		InvalidateFolder(AssetData.PackagePath);
+	}
+}
+
+void FBVHImporterModule::OnAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath)
+{
+	if (IsSkeletonAsset(AssetData))
+	{
+		// The skeleton left its old folder and may now be the better fit in the new one
+		const FString OldPackageName = FPackageName::ObjectPathToPackageName(OldObjectPath);
+		InvalidateFolder(FName(*FPaths::GetPath(OldPackageName)));
+		InvalidateFolder(AssetData.PackagePath);
+	}
+}
 
+bool FBVHImporterModule::IsSkeletonAsset(const FAssetData& AssetData) const
+{
+	return SkeletonClassPaths.Contains(AssetData.AssetClassPath);
+}
+
+void FBVHImporterModule::InvalidateFolder(FName FolderPath)
+{
+	for (auto It = SkeletonCache.CreateIterator(); It; ++It)
+	{
+		if (It.Key().Key == FolderPath)
+		{
+			It.RemoveCurrent();
+		}
+	}
 }
 
 #undef LOCTEXT_NAMESPACE
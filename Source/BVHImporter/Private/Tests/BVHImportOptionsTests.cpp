@@ -0,0 +1,463 @@
+#include "Animation/AnimSequence.h"
+#include "BVHBinaryCache.h"
+#include "BVHImportPipeline.h"
+#include "BVHImportSettings.h"
+#include "BVHImportUserData.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace {
+
+constexpr EAutomationTestFlags TestFlags =
+    EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter;
+
+// A 120 Hz take with an animated root and spine and a finger that never
+// moves, written to the automation transient folder
+FString WriteTestTake(const TCHAR *Name, int32 NumFrames) {
+  FString Text = TEXT("HIERARCHY\n"
+                      "ROOT Hips\n"
+                      "{\n"
+                      "\tOFFSET 0.0 90.0 0.0\n"
+                      "\tCHANNELS 6 Xposition Yposition Zposition Zrotation "
+                      "Xrotation Yrotation\n"
+                      "\tJOINT Spine\n"
+                      "\t{\n"
+                      "\t\tOFFSET 0.0 10.0 0.0\n"
+                      "\t\tCHANNELS 3 Zrotation Xrotation Yrotation\n"
+                      "\t\tJOINT Finger\n"
+                      "\t\t{\n"
+                      "\t\t\tOFFSET 0.0 5.0 0.0\n"
+                      "\t\t\tCHANNELS 3 Zrotation Xrotation Yrotation\n"
+                      "\t\t\tEnd Site\n"
+                      "\t\t\t{\n"
+                      "\t\t\t\tOFFSET 0.0 2.0 0.0\n"
+                      "\t\t\t}\n"
+                      "\t\t}\n"
+                      "\t}\n"
+                      "}\n"
+                      "MOTION\n");
+  Text += FString::Printf(TEXT("Frames: %d\nFrame Time: 0.00833333\n"),
+                          NumFrames);
+  for (int32 Frame = 0; Frame < NumFrames; ++Frame) {
+    const double Angle = FMath::Sin(Frame * 0.05) * 45.0;
+    Text += FString::Printf(
+        TEXT("%.6f 90.0 0.0 %.6f 0.0 0.0 %.6f %.6f 0.0 10.0 20.0 30.0\n"),
+        Frame * 0.1, Frame * 0.5, Angle, -Angle);
+  }
+
+  const FString Filename =
+      FPaths::Combine(FPaths::AutomationTransientDir(), Name);
+  FFileHelper::SaveStringToFile(Text, *Filename);
+  return Filename;
+}
+
+// Settings that keep the tests off the project's rate, and options that keep
+// them off the binary cache
+UBVHImportSettings *MakeTestSettings() {
+  UBVHImportSettings *Settings = NewObject<UBVHImportSettings>();
+  Settings->bKeepSourceFrameRate = true;
+  return Settings;
+}
+
+FBVHImportOptions MakeTestOptions(const UBVHImportSettings &Settings) {
+  FBVHImportOptions Options;
+  Settings.ApplyTo(Options);
+  Options.bUseBinaryCache = false;
+  return Options;
+}
+
+bool TracksMatch(const FBVHImportPayload &A, const FBVHImportPayload &B) {
+  if (A.Tracks.Num() != B.Tracks.Num()) {
+    return false;
+  }
+  for (int32 TrackIndex = 0; TrackIndex < A.Tracks.Num(); ++TrackIndex) {
+    const FBVHBoneTrack &TrackA = A.Tracks[TrackIndex];
+    const FBVHBoneTrack &TrackB = B.Tracks[TrackIndex];
+    if (TrackA.BoneName != TrackB.BoneName ||
+        TrackA.PositionalKeys != TrackB.PositionalKeys ||
+        TrackA.RotationalKeys != TrackB.RotationalKeys) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBVHImportDerivedDataCacheTest,
+                                 "BVHImporter.Options.DerivedDataCache",
+                                 TestFlags)
+
+bool FBVHImportDerivedDataCacheTest::RunTest(const FString &Parameters) {
+  UBVHImportSettings *Settings = MakeTestSettings();
+  const FBVHImportOptions UncachedOptions = MakeTestOptions(*Settings);
+  Settings->bUseDerivedDataCache = true;
+  const FBVHImportOptions Options = MakeTestOptions(*Settings);
+  TestTrue(TEXT("Settings enable the DDC"), Options.bUseDerivedDataCache);
+
+  const FString Filename = WriteTestTake(TEXT("DerivedDataCache.bvh"), 300);
+  FBVHImportPayload Converted;
+  if (!TestTrue(TEXT("Converts without the DDC"),
+                BVHImportPipeline::ParseAndConvert(Filename, Converted,
+                                                   UncachedOptions))) {
+    return false;
+  }
+
+  // The first run fills the cache, the second reads it back into a recycled
+  // payload that still holds the first run's tracks
+  FBVHImportPayload Cached;
+  for (int32 Run = 0; Run < 2; ++Run) {
+    if (!TestTrue(TEXT("Converts through the DDC"),
+                  BVHImportPipeline::ParseAndConvert(Filename, Cached,
+                                                     Options))) {
+      return false;
+    }
+    TestTrue(FString::Printf(TEXT("Run %d matches the uncached tracks"), Run),
+             TracksMatch(Converted, Cached));
+  }
+  return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBVHImportFrameRateTest,
+                                 "BVHImporter.Options.FrameRate", TestFlags)
+
+bool FBVHImportFrameRateTest::RunTest(const FString &Parameters) {
+  const FString Filename = WriteTestTake(TEXT("FrameRate.bvh"), 301);
+
+  // 300 source frames at 120 Hz span 2.5 seconds, 75 frames at 30 Hz
+  UBVHImportSettings *Settings = MakeTestSettings();
+  Settings->TargetFrameRate = FFrameRate(30, 1);
+  Settings->bKeepSourceFrameRate = false;
+  FBVHImportOptions Options = MakeTestOptions(*Settings);
+
+  FBVHImportPayload Payload;
+  if (!TestTrue(TEXT("Converts at the target rate"),
+                BVHImportPipeline::ParseAndConvert(Filename, Payload,
+                                                   Options))) {
+    return false;
+  }
+  TestTrue(TEXT("Sampled at the target rate"),
+           Payload.FrameRate == FFrameRate(30, 1));
+  TestEqual(TEXT("Resampled key count"), Payload.NumKeys, 76);
+  for (const FBVHBoneTrack &Track : Payload.Tracks) {
+    TestEqual(TEXT("Track holds every resampled key"),
+              Track.PositionalKeys.Num(), Payload.NumKeys);
+  }
+
+  // Streamed takes convert every frame and resample afterwards, whole takes
+  // only convert the frames the keys bracket. Both land on the same keys.
+  FBVHImportOptions StreamedOptions = Options;
+  StreamedOptions.StreamingThresholdBytes = 1;
+  FBVHImportPayload Streamed;
+  if (!TestTrue(TEXT("Streams at the target rate"),
+                BVHImportPipeline::ParseAndConvert(Filename, Streamed,
+                                                   StreamedOptions))) {
+    return false;
+  }
+  TestEqual(TEXT("Streamed key count"), Streamed.NumKeys, Payload.NumKeys);
+  for (int32 TrackIndex = 0; TrackIndex < Payload.Tracks.Num() &&
+                             TrackIndex < Streamed.Tracks.Num();
+       ++TrackIndex) {
+    const FBVHBoneTrack &Track = Payload.Tracks[TrackIndex];
+    const FBVHBoneTrack &StreamedTrack = Streamed.Tracks[TrackIndex];
+    for (int32 Key = 0; Key < Track.PositionalKeys.Num() &&
+                        Key < StreamedTrack.PositionalKeys.Num();
+         ++Key) {
+      if (!Track.PositionalKeys[Key].Equals(StreamedTrack.PositionalKeys[Key],
+                                            1e-6) ||
+          !Track.RotationalKeys[Key].Equals(StreamedTrack.RotationalKeys[Key],
+                                            1e-6)) {
+        AddError(FString::Printf(TEXT("%s key %d differs when streamed"),
+                                 *Track.BoneName.ToString(), Key));
+        break;
+      }
+    }
+  }
+
+  Settings->bKeepSourceFrameRate = true;
+  Options = MakeTestOptions(*Settings);
+  if (!TestTrue(TEXT("Converts at the source rate"),
+                BVHImportPipeline::ParseAndConvert(Filename, Payload,
+                                                   Options))) {
+    return false;
+  }
+  TestTrue(TEXT("Sampled at the source rate"),
+           Payload.FrameRate == FFrameRate(120, 1));
+  TestEqual(TEXT("Source frames map 1:1"), Payload.NumKeys, 301);
+  return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBVHImportFrameWindowTest,
+                                 "BVHImporter.Options.FrameWindow", TestFlags)
+
+bool FBVHImportFrameWindowTest::RunTest(const FString &Parameters) {
+  // Every second frame of 100..159 keeps 30 frames at half the file's rate
+  UBVHImportSettings *Settings = MakeTestSettings();
+  Settings->FirstFrame = 100;
+  Settings->NumFrames = 60;
+  Settings->FrameStride = 2;
+  const FBVHImportOptions Options = MakeTestOptions(*Settings);
+  TestEqual(TEXT("First frame"), Options.FirstFrame, 100);
+  TestEqual(TEXT("Frame count"), Options.NumFrames, 60);
+  TestEqual(TEXT("Frame stride"), Options.FrameStride, 2);
+
+  const FString Filename = WriteTestTake(TEXT("FrameWindow.bvh"), 300);
+  FBVHImportPayload Payload;
+  if (!TestTrue(TEXT("Converts the window"),
+                BVHImportPipeline::ParseAndConvert(Filename, Payload,
+                                                   Options))) {
+    return false;
+  }
+  TestEqual(TEXT("Windowed key count"), Payload.NumKeys, 30);
+  TestTrue(TEXT("Sampled at the strided rate"),
+           Payload.FrameRate == FFrameRate(60, 1));
+  for (const FBVHBoneTrack &Track : Payload.Tracks) {
+    TestEqual(TEXT("Track holds every windowed key"),
+              Track.PositionalKeys.Num(), 30);
+  }
+
+  // The root moves 0.1 along X per source frame, so its keys start at frame
+  // 100 and advance two frames each
+  for (const FBVHBoneTrack &Track : Payload.Tracks) {
+    if (Track.BoneName == FName(TEXT("Hips")) &&
+        Track.PositionalKeys.Num() > 1) {
+      TestEqual(TEXT("Window starts at its first frame"),
+                Track.PositionalKeys[0].X, 10.0, 1e-4);
+      TestEqual(TEXT("Keys are a stride apart"), Track.PositionalKeys[1].X,
+                10.2, 1e-4);
+    }
+  }
+  return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBVHImportJointFilterTest,
+                                 "BVHImporter.Options.JointFilter", TestFlags)
+
+bool FBVHImportJointFilterTest::RunTest(const FString &Parameters) {
+  UBVHImportSettings *Settings = MakeTestSettings();
+  Settings->ExcludeBones = {TEXT("Fin*")};
+  Settings->bExcludeEndSites = true;
+  const FBVHImportOptions Options = MakeTestOptions(*Settings);
+  TestTrue(TEXT("Exclude patterns"),
+           Options.ExcludeBones == TArray<FString>{TEXT("Fin*")});
+  TestTrue(TEXT("Exclude end sites"), Options.bExcludeEndSites);
+
+  const FString Filename = WriteTestTake(TEXT("JointFilter.bvh"), 300);
+  FBVHImportPayload Payload;
+  if (!TestTrue(TEXT("Converts the filtered joints"),
+                BVHImportPipeline::ParseAndConvert(Filename, Payload,
+                                                   Options))) {
+    return false;
+  }
+
+  // The finger and the end site below it stay in the hierarchy untracked
+  TestEqual(TEXT("Parsed joints"), Payload.Data.Nodes.Num(), 4);
+  TArray<FName> BoneNames;
+  for (const FBVHBoneTrack &Track : Payload.Tracks) {
+    BoneNames.Add(Track.BoneName);
+  }
+  TestTrue(TEXT("Only the root and spine are tracked"),
+           BoneNames ==
+               TArray<FName>{FName(TEXT("Hips")), FName(TEXT("Spine"))});
+  return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBVHImportReduceConstantTest,
+                                 "BVHImporter.Options.ReduceConstantTracks",
+                                 TestFlags)
+
+bool FBVHImportReduceConstantTest::RunTest(const FString &Parameters) {
+  UBVHImportSettings *Settings = MakeTestSettings();
+  Settings->bReduceConstantTracks = true;
+  const FBVHImportOptions Options = MakeTestOptions(*Settings);
+
+  const FString Filename = WriteTestTake(TEXT("ReduceConstant.bvh"), 300);
+  FBVHImportPayload Payload;
+  if (!TestTrue(TEXT("Converts with constant reduction"),
+                BVHImportPipeline::ParseAndConvert(Filename, Payload,
+                                                   Options))) {
+    return false;
+  }
+
+  for (const FBVHBoneTrack &Track : Payload.Tracks) {
+    // Only the finger holds still for the whole take
+    const int32 ExpectedKeys =
+        Track.BoneName == TEXT("Finger") ? 1 : Payload.NumKeys;
+    TestEqual(FString::Printf(TEXT("%s position keys"),
+                              *Track.BoneName.ToString()),
+              Track.PositionalKeys.Num(), ExpectedKeys);
+    TestEqual(FString::Printf(TEXT("%s rotation keys"),
+                              *Track.BoneName.ToString()),
+              Track.RotationalKeys.Num(), ExpectedKeys);
+  }
+  return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBVHImportReimportOptionsTest,
+                                 "BVHImporter.Options.Reimport", TestFlags)
+
+bool FBVHImportReimportOptionsTest::RunTest(const FString &Parameters) {
+  UAnimSequence *AnimSequence =
+      NewObject<UAnimSequence>(GetTransientPackage());
+  FBVHImportOptions Options;
+  TestFalse(TEXT("Nothing to restore without a BVH import record"),
+            BVHImportPipeline::RestoreImportOptions(AnimSequence, Options));
+
+  UBVHImportUserData *UserData = NewObject<UBVHImportUserData>(AnimSequence);
+  UserData->TargetFrameRate = FFrameRate(24, 1);
+  UserData->bKeepSourceFrameRate = true;
+  UserData->bReduceConstantTracks = true;
+  UserData->ConstantPositionTolerance = 0.5;
+  UserData->ConstantRotationTolerance = 2.0;
+  UserData->FirstFrame = 100;
+  UserData->NumFrames = 600;
+  UserData->FrameStride = 4;
+  UserData->IncludeBones = {TEXT("Spine*")};
+  UserData->ExcludeBones = {TEXT("*Thumb*")};
+  UserData->bExcludeEndSites = true;
+  AnimSequence->AddAssetUserData(UserData);
+
+  // Settings differing from the record must not leak into the reimport
+  UBVHImportSettings *Settings = NewObject<UBVHImportSettings>();
+  Settings->TargetFrameRate = FFrameRate(60, 1);
+  Settings->ApplyTo(Options);
+  if (!TestTrue(TEXT("Restores the recorded options"),
+                BVHImportPipeline::RestoreImportOptions(AnimSequence,
+                                                        Options))) {
+    return false;
+  }
+  TestTrue(TEXT("Target frame rate"),
+           Options.TargetFrameRate == FFrameRate(24, 1));
+  TestTrue(TEXT("Keep source frame rate"), Options.bKeepSourceFrameRate);
+  TestTrue(TEXT("Reduce constant tracks"), Options.bReduceConstantTracks);
+  TestEqual(TEXT("Position tolerance"), Options.ConstantPositionTolerance,
+            0.5);
+  TestEqual(TEXT("Rotation tolerance"), Options.ConstantRotationTolerance,
+            2.0);
+  TestEqual(TEXT("First frame"), Options.FirstFrame, 100);
+  TestEqual(TEXT("Frame count"), Options.NumFrames, 600);
+  TestEqual(TEXT("Frame stride"), Options.FrameStride, 4);
+  TestTrue(TEXT("Include patterns"),
+           Options.IncludeBones == TArray<FString>{TEXT("Spine*")});
+  TestTrue(TEXT("Exclude patterns"),
+           Options.ExcludeBones == TArray<FString>{TEXT("*Thumb*")});
+  TestTrue(TEXT("Exclude end sites"), Options.bExcludeEndSites);
+  return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBVHImportSourceHashesTest,
+                                 "BVHImporter.Options.SourceHashes", TestFlags)
+
+bool FBVHImportSourceHashesTest::RunTest(const FString &Parameters) {
+  const FString Filename = WriteTestTake(TEXT("SourceHashes.bvh"), 300);
+  FBVHImportOptions Options = MakeTestOptions(*MakeTestSettings());
+  FBVHImportPayload Original;
+  if (!TestTrue(TEXT("Converts the original take"),
+                BVHImportPipeline::ParseAndConvert(Filename, Original,
+                                                   Options))) {
+    return false;
+  }
+  for (int32 TrackIndex = 0; TrackIndex < Original.Tracks.Num();
+       ++TrackIndex) {
+    Options.PreviousSourceHashes.Add(Original.Tracks[TrackIndex].BoneName,
+                                     Original.SourceHashes[TrackIndex]);
+  }
+
+  // The same file against its own hashes converts nothing
+  FBVHImportPayload Reimported;
+  if (!TestTrue(TEXT("Reconverts the unchanged take"),
+                BVHImportPipeline::ParseAndConvert(Filename, Reimported,
+                                                   Options))) {
+    return false;
+  }
+  TestEqual(TEXT("Every track is unchanged"),
+            Reimported.UnchangedTracks.CountSetBits(),
+            Reimported.Tracks.Num());
+  for (const FBVHBoneTrack &Track : Reimported.Tracks) {
+    TestEqual(TEXT("Unchanged tracks hold no keys"),
+              Track.PositionalKeys.Num(), 0);
+  }
+
+  // Moving the finger converts only the finger
+  FString Text;
+  FFileHelper::LoadFileToString(Text, *Filename);
+  Text.ReplaceInline(TEXT(" 10.0 20.0 30.0\n"), TEXT(" 15.0 20.0 30.0\n"));
+  FFileHelper::SaveStringToFile(Text, *Filename);
+  if (!TestTrue(TEXT("Reconverts the edited take"),
+                BVHImportPipeline::ParseAndConvert(Filename, Reimported,
+                                                   Options))) {
+    return false;
+  }
+  for (int32 TrackIndex = 0; TrackIndex < Reimported.Tracks.Num();
+       ++TrackIndex) {
+    const FBVHBoneTrack &Track = Reimported.Tracks[TrackIndex];
+    const bool bFinger = Track.BoneName == FName(TEXT("Finger"));
+    TestEqual(FString::Printf(TEXT("%s is converted only when edited"),
+                              *Track.BoneName.ToString()),
+              static_cast<bool>(Reimported.UnchangedTracks[TrackIndex]),
+              !bFinger);
+    TestEqual(FString::Printf(TEXT("%s keys"), *Track.BoneName.ToString()),
+              Track.PositionalKeys.Num(), bFinger ? Reimported.NumKeys : 0);
+  }
+  return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBVHBinaryCacheTest, "BVHImporter.BinaryCache",
+                                 TestFlags)
+
+bool FBVHBinaryCacheTest::RunTest(const FString &Parameters) {
+  UBVHImportSettings *Settings = NewObject<UBVHImportSettings>();
+  Settings->bUseBinaryCache = false;
+  FBVHImportOptions Options;
+  Settings->ApplyTo(Options);
+  TestFalse(TEXT("Settings turn the binary cache off"),
+            Options.bUseBinaryCache);
+
+  const FString Filename = WriteTestTake(TEXT("BinaryCache.bvh"), 120);
+  FBVHData Parsed;
+  if (!TestTrue(TEXT("Parses the take"), FBVHParser(Filename).Parse(Parsed)) ||
+      !TestTrue(TEXT("Writes the entry"),
+                FBVHBinaryCache::Save(Filename, Parsed))) {
+    return false;
+  }
+
+  FBVHData Cached;
+  TestTrue(TEXT("Loads the entry"), FBVHBinaryCache::Load(Filename, Cached));
+  TestTrue(TEXT("Entry holds the parsed motion"),
+           Cached.NumFrames == Parsed.NumFrames &&
+               Cached.MotionData == Parsed.MotionData);
+
+  // A touched but identical file keeps its entry
+  const FDateTime Stamp = IFileManager::Get().GetTimeStamp(*Filename);
+  IFileManager::Get().SetTimeStamp(*Filename, Stamp + FTimespan::FromHours(1));
+  TestTrue(TEXT("Touched file still hits"),
+           FBVHBinaryCache::Load(Filename, Cached));
+
+  // An edit of the same length with its timestamp restored must miss
+  FString Text;
+  FFileHelper::LoadFileToString(Text, *Filename);
+  Text.ReplaceInline(TEXT("10.0 20.0 30.0"), TEXT("10.0 20.0 31.0"));
+  FFileHelper::SaveStringToFile(Text, *Filename);
+  IFileManager::Get().SetTimeStamp(*Filename, Stamp);
+  TestFalse(TEXT("Edited file misses"),
+            FBVHBinaryCache::Load(Filename, Cached));
+
+  // The new entry replaces the old one under the same path
+  const FString CachePath = FBVHBinaryCache::GetCachePath(Filename);
+  FBVHData Edited;
+  FBVHParser(Filename).Parse(Edited);
+  TestTrue(TEXT("Rewrites the entry"), FBVHBinaryCache::Save(Filename, Edited));
+  TestEqual(TEXT("One entry per source"),
+            FBVHBinaryCache::GetCachePath(Filename), CachePath);
+  TestTrue(TEXT("Rewritten entry hits"),
+           FBVHBinaryCache::Load(Filename, Cached));
+  IFileManager::Get().Delete(*CachePath);
+  return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -1,11 +1,13 @@
 #pragma once
 #include "CoreMinimal.h"
+#include "EditorReimportHandler.h"
 #include "Factories/Factory.h"
 #include "BVHFactory.generated.h"
 
-
+// Imports a .bvh file as an AnimSequence with its skeleton. Reimports rewrite
+// only the bone tracks whose keys changed since the last import.
 UCLASS()
-class UBVHFactory : public UFactory {
+class UBVHFactory : public UFactory, public FReimportHandler {
   GENERATED_BODY()
 
 public:
@@ -17,4 +19,13 @@ public:
                                      const TCHAR *Parms, FFeedbackContext *Warn,
                                      bool &bOutOperationCanceled) override;
   virtual bool FactoryCanImport(const FString &Filename) override;
+
+  // FReimportHandler
+  virtual bool CanReimport(UObject *Obj,
+                           TArray<FString> &OutFilenames) override;
+  virtual void
+  SetReimportPaths(UObject *Obj,
+                   const TArray<FString> &NewReimportPaths) override;
+  virtual EReimportResult::Type Reimport(UObject *Obj) override;
+  virtual int32 GetPriority() const override;
 };
@@ -0,0 +1,36 @@
+#pragma once
+#include "Commandlets/Commandlet.h"
+#include "CoreMinimal.h"
+#include "BVHImportCommandlet.generated.h"
+
+// Headless bulk conversion for build farms. Runs the batch pipeline over a
+// directory or a manifest, saves the packages in batches and reports
+// throughput.
+//
+// UnrealEditor-Cmd <Project> -run=BVHImport -Dest=/Game/Mocap
+//   (-Source=<Directory> | -Manifest=<File>) [-Shard=<Index>/<Count>]
+//   [-BatchSize=<Files>] [-FirstFrame=<Frame>] [-NumFrames=<Frames>]
+//   [-FrameStride=<N>] [-IncludeBones=<Patterns>] [-ExcludeBones=<Patterns>]
+//   [-ExcludeEndSites] [-NoDDC] [-NoBinaryCache] [-FrameRate=<Rate>]
+//   [-KeepSourceFrameRate] [-ReduceConstant]
+//
+// A manifest lists one .bvh path per line, relative paths are resolved
+// against the manifest's folder. With -Shard each agent takes every Count-th
+// file of the sorted list, starting at Index. The frame options import only a
+// window of every take, keeping every N-th frame of it. Bone patterns are
+// comma separated wildcards, e.g. -ExcludeBones=*Thumb*,*Index*. Converted
+// tracks are shared through the DerivedDataCache unless -NoDDC is passed, and
+// -NoBinaryCache skips the parsed copies in Intermediate/BVHCache.
+// -FrameRate resamples to a rate such as 30 or 30000/1001 and
+// -KeepSourceFrameRate keeps each file's own rate, otherwise the editor
+// settings decide. -ReduceConstant collapses tracks that never move to a
+// single key.
+UCLASS()
+class UBVHImportCommandlet : public UCommandlet {
+  GENERATED_BODY()
+
+public:
+  UBVHImportCommandlet();
+
+  virtual int32 Main(const FString &Params) override;
+};
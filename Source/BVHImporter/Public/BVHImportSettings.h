@@ -0,0 +1,82 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "Misc/FrameRate.h"
+#include "BVHImportSettings.generated.h"
+
+struct FBVHImportOptions;
+
+// Defaults for content browser and BVH.ImportDirectory imports, under Editor
+// Preferences > Plugins > BVH Importer. The commandlet starts from them and
+// its switches override them.
+UCLASS(Config = EditorPerProjectUserSettings)
+class UBVHImportSettings : public UDeveloperSettings {
+  GENERATED_BODY()
+
+public:
+  UBVHImportSettings();
+
+  // Keep a binary copy of each parsed file in Intermediate/BVHCache and read
+  // it back on reimport while the source content is unchanged
+  UPROPERTY(Config, EditAnywhere, Category = "Caching")
+  bool bUseBinaryCache = true;
+
+  // Share converted bone tracks through the DerivedDataCache, so files
+  // another machine already converted skip the conversion
+  UPROPERTY(Config, EditAnywhere, Category = "Caching")
+  bool bUseDerivedDataCache = false;
+
+  // Rate the sequence is sampled at, keys are resampled from the file's Frame
+  // Time. Left at 0/0, the project's default animation frame rate is used.
+  UPROPERTY(Config, EditAnywhere, Category = "Sampling")
+  FFrameRate TargetFrameRate = FFrameRate(0, 0);
+
+  // Keep the file's own rate and import its frames 1:1
+  UPROPERTY(Config, EditAnywhere, Category = "Sampling")
+  bool bKeepSourceFrameRate = false;
+
+  // Frame window: NumFrames source frames from FirstFrame on, keeping every
+  // FrameStride-th. NumFrames of -1 runs to the end of the take. Windowed
+  // imports bypass the binary cache and the DDC.
+  UPROPERTY(Config, EditAnywhere, Category = "Sampling",
+            meta = (ClampMin = "0"))
+  int32 FirstFrame = 0;
+
+  UPROPERTY(Config, EditAnywhere, Category = "Sampling",
+            meta = (ClampMin = "-1"))
+  int32 NumFrames = INDEX_NONE;
+
+  UPROPERTY(Config, EditAnywhere, Category = "Sampling",
+            meta = (ClampMin = "1"))
+  int32 FrameStride = 1;
+
+  // Joint filter applied before conversion, with * and ? wildcards. An empty
+  // include list keeps every joint, excludes win over includes. Filtered
+  // joints stay in the skeleton but get no track.
+  UPROPERTY(Config, EditAnywhere, Category = "Joints")
+  TArray<FString> IncludeBones;
+
+  UPROPERTY(Config, EditAnywhere, Category = "Joints")
+  TArray<FString> ExcludeBones;
+
+  UPROPERTY(Config, EditAnywhere, Category = "Joints")
+  bool bExcludeEndSites = false;
+
+  // Collapse tracks that stay within the tolerances below for the whole take,
+  // such as fingers and end sites, to a single key
+  UPROPERTY(Config, EditAnywhere, Category = "Reduction")
+  bool bReduceConstantTracks = false;
+
+  UPROPERTY(Config, EditAnywhere, Category = "Reduction",
+            meta = (ClampMin = "0", Units = "Centimeters",
+                    EditCondition = "bReduceConstantTracks"))
+  double ConstantPositionTolerance = 0.001;
+
+  UPROPERTY(Config, EditAnywhere, Category = "Reduction",
+            meta = (ClampMin = "0", Units = "Degrees",
+                    EditCondition = "bReduceConstantTracks"))
+  double ConstantRotationTolerance = 0.01;
+
+  // Copies the settings onto Options
+  void ApplyTo(FBVHImportOptions &Options) const;
+};
@@ -2,6 +2,10 @@
 
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
+#include "UObject/TopLevelAssetPath.h"
+
+class USkeleton;
+struct FAssetData;
 
 class FBVHImporterModule : public IModuleInterface
 {
@@ -10,4 +14,32 @@ public:
 
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+	static FBVHImporterModule& Get();
+
+	/**
+	 * Returns the skeleton to use for a hierarchy imported into FolderPath. Hits are constant time; a miss runs one
+	 * class-filtered registry query on the folder and prefers a skeleton that contains every bone in BoneNames.
+	 */
+	USkeleton* FindSkeleton(const FString& FolderPath, uint32 HierarchyHash, TConstArrayView<FName> BoneNames);
+
+	/** Records a skeleton created by an import so later files in the same folder resolve to it */
+	void RegisterSkeleton(const FString& FolderPath, uint32 HierarchyHash, USkeleton* Skeleton);
+
+private:
+	void OnAssetAdded(const FAssetData& AssetData);
+	void OnAssetRemoved(const FAssetData& AssetData);
+	void OnAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath);
+	bool IsSkeletonAsset(const FAssetData& AssetData) const;
+	void InvalidateFolder(FName FolderPath);
+
+	// Folder and hierarchy hash -> skeleton
+	TMap<TPair<FName, uint32>, TWeakObjectPtr<USkeleton>> SkeletonCache;
+
+	// USkeleton and its derived classes, gathered once at startup
+	TSet<FTopLevelAssetPath> SkeletonClassPaths;
+
+	FDelegateHandle OnAssetAddedHandle;
+	FDelegateHandle OnAssetRemovedHandle;
+	FDelegateHandle OnAssetRenamedHandle;
 };
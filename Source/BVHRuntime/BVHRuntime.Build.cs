@@ -0,0 +1,25 @@
+using UnrealBuildTool;
+
+public class BVHRuntime : ModuleRules
+{
+	public BVHRuntime(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+				"CoreUObject",
+				"Engine",
+			}
+			);
+
+		PrivateDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Sockets",
+			}
+			);
+	}
+}
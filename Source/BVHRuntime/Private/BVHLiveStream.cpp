@@ -0,0 +1,218 @@
+#include "BVHLiveStream.h"
+#include "BVHParser.h"
+#include "BVHRuntimeLog.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/RunnableThread.h"
+#include "SocketSubsystem.h"
+#include "Sockets.h"
+#include <cstring>
+
+namespace
+{
+	constexpr int32 ReceiveBufferSize = 64 * 1024;
+
+	// How long the worker sleeps in a socket wait before it checks for a stop request
+	const FTimespan PollInterval = FTimespan::FromMilliseconds(100);
+}
+
+FBVHLiveStream::FBVHLiveStream(int32 NumChannels, const FBVHLiveStreamSettings& InSettings)
+	: Settings(InSettings)
+{
+	Frames.Initialize(NumChannels, Settings.RingCapacity);
+	PendingLine.Reserve(ReceiveBufferSize);
+}
+
+FBVHLiveStream::~FBVHLiveStream()
+{
+	Shutdown();
+}
+
+bool FBVHLiveStream::Start()
+{
+	check(!Thread);
+	bStopRequested = false;
+	Thread = FRunnableThread::Create(this, TEXT("BVHLiveStream"), 0, TPri_AboveNormal);
+	return Thread != nullptr;
+}
+
+void FBVHLiveStream::Shutdown()
+{
+	if (Thread)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+void FBVHLiveStream::Stop()
+{
+	bStopRequested = true;
+}
+
+uint32 FBVHLiveStream::Run()
+{
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	TArray<uint8> ReceiveBuffer;
+	ReceiveBuffer.SetNumUninitialized(ReceiveBufferSize);
+
+	while (!bStopRequested)
+	{
+		FSocket* Socket = OpenSocket();
+		if (!Socket)
+		{
+			// Sleep in short steps so Stop is not held up by the reconnect delay
+			const double RetryTime = FPlatformTime::Seconds() + Settings.ReconnectSeconds;
+			while (!bStopRequested && FPlatformTime::Seconds() < RetryTime)
+			{
+				FPlatformProcess::Sleep(PollInterval.GetTotalSeconds());
+			}
+			continue;
+		}
+
+		UE_LOG(LogBVHRuntime, Log, TEXT("BVHLiveStream: Listening to %s:%d"), *Settings.Host, Settings.Port);
+		bConnected = true;
+		PendingLine.Reset();
+
+		while (!bStopRequested)
+		{
+			if (!Socket->Wait(ESocketWaitConditions::WaitForRead, PollInterval))
+			{
+				if (Settings.Protocol == EBVHLiveProtocol::Tcp && Socket->GetConnectionState() != SCS_Connected)
+				{
+					break;
+				}
+				continue;
+			}
+
+			int32 BytesRead = 0;
+			if (!Socket->Recv(ReceiveBuffer.GetData(), ReceiveBuffer.Num(), BytesRead))
+			{
+				// Stream sockets report a closed connection as a failed read
+				break;
+			}
+			ConsumeBytes(ReceiveBuffer.GetData(), BytesRead);
+
+			// A datagram never continues in the next one, its last line ends with it
+			if (Settings.Protocol == EBVHLiveProtocol::Udp && PendingLine.Num() > 0)
+			{
+				ParseLine(FAnsiStringView(PendingLine.GetData(), PendingLine.Num()));
+				PendingLine.Reset();
+			}
+		}
+
+		bConnected = false;
+		Socket->Close();
+		SocketSubsystem->DestroySocket(Socket);
+		UE_LOG(LogBVHRuntime, Log, TEXT("BVHLiveStream: Disconnected from %s:%d"), *Settings.Host, Settings.Port);
+	}
+	return 0;
+}
+
+FSocket* FBVHLiveStream::OpenSocket() const
+{
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	if (!SocketSubsystem)
+	{
+		return nullptr;
+	}
+
+	FSocket* Socket = nullptr;
+	if (Settings.Protocol == EBVHLiveProtocol::Tcp)
+	{
+		TSharedPtr<FInternetAddr> Address = SocketSubsystem->GetAddressFromString(Settings.Host);
+		if (!Address.IsValid())
+		{
+			UE_LOG(LogBVHRuntime, Warning, TEXT("BVHLiveStream: '%s' is not an IP address"), *Settings.Host);
+			return nullptr;
+		}
+		Address->SetPort(Settings.Port);
+
+		Socket = SocketSubsystem->CreateSocket(NAME_Stream, TEXT("BVHLiveStream"), Address->GetProtocolType());
+		if (Socket && !Socket->Connect(*Address))
+		{
+			SocketSubsystem->DestroySocket(Socket);
+			Socket = nullptr;
+		}
+	}
+	else
+	{
+		TSharedRef<FInternetAddr> Address = SocketSubsystem->CreateInternetAddr();
+		Address->SetAnyAddress();
+		Address->SetPort(Settings.Port);
+
+		Socket = SocketSubsystem->CreateSocket(NAME_DGram, TEXT("BVHLiveStream"), Address->GetProtocolType());
+		if (Socket && (!Socket->SetReuseAddr() || !Socket->Bind(*Address)))
+		{
+			SocketSubsystem->DestroySocket(Socket);
+			Socket = nullptr;
+		}
+	}
+
+	if (Socket)
+	{
+		int32 ActualSize = 0;
+		Socket->SetReceiveBufferSize(ReceiveBufferSize * 4, ActualSize);
+	}
+	return Socket;
+}
+
+void FBVHLiveStream::ConsumeBytes(const uint8* Data, int32 NumBytes)
+{
+	const ANSICHAR* Cursor = reinterpret_cast<const ANSICHAR*>(Data);
+	const ANSICHAR* End = Cursor + NumBytes;
+	while (Cursor < End)
+	{
+		const ANSICHAR* LineEnd = static_cast<const ANSICHAR*>(memchr(Cursor, '\n', End - Cursor));
+		if (!LineEnd)
+		{
+			// Lines longer than the buffer are garbage, drop them rather than grow without bound
+			if (PendingLine.Num() + (End - Cursor) > ReceiveBufferSize)
+			{
+				PendingLine.Reset();
+				NumMalformedLines.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			PendingLine.Append(Cursor, End - Cursor);
+			return;
+		}
+
+		if (PendingLine.Num() > 0)
+		{
+			PendingLine.Append(Cursor, LineEnd - Cursor);
+			ParseLine(FAnsiStringView(PendingLine.GetData(), PendingLine.Num()));
+			PendingLine.Reset();
+		}
+		else
+		{
+			ParseLine(FAnsiStringView(Cursor, LineEnd - Cursor));
+		}
+		Cursor = LineEnd + 1;
+	}
+}
+
+void FBVHLiveStream::ParseLine(FAnsiStringView Line)
+{
+	Line.TrimStartAndEndInline();
+	if (Line.IsEmpty())
+	{
+		return;
+	}
+
+	double* Slot = Frames.BeginWrite();
+	if (!Slot)
+	{
+		// The consumer is a full ring behind, the ring counts the dropped frame
+		return;
+	}
+
+	if (FBVHParser::ParseFrameLine(Line, TArrayView<double>(Slot, Frames.GetNumChannels()), Settings.NumLeadingTokens))
+	{
+		Frames.EndWrite(FPlatformTime::Seconds());
+	}
+	else
+	{
+		NumMalformedLines.fetch_add(1, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,179 @@
+#include "BVHLiveStreamComponent.h"
+#include "BVHRuntimeLog.h"
+#include "BVHTrackConversion.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/Actor.h"
+
+UBVHLiveStreamComponent::UBVHLiveStreamComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickGroup = TG_PrePhysics;
+}
+
+bool UBVHLiveStreamComponent::Connect()
+{
+	FBVHParseOptions ParseOptions;
+	ParseOptions.bParallelMotion = false;
+
+	FBVHData Hierarchy;
+	FBVHParser Parser(HierarchyFile.FilePath, ParseOptions);
+	if (!Parser.Parse(Hierarchy))
+	{
+		UE_LOG(LogBVHRuntime, Error, TEXT("BVHLiveStream: Cannot read the hierarchy from '%s'"), *HierarchyFile.FilePath);
+		return false;
+	}
+	Hierarchy.MotionData.Empty();
+	Hierarchy.NumFrames = 0;
+	return ConnectWithHierarchy(Hierarchy);
+}
+
+bool UBVHLiveStreamComponent::ConnectWithHierarchy(const FBVHData& Hierarchy)
+{
+	Disconnect();
+	if (Hierarchy.Nodes.Num() == 0 || Hierarchy.NumChannels <= 0)
+	{
+		return false;
+	}
+
+	// Everything the tick touches is sized here, once per connection
+	Converter.Initialize(Hierarchy);
+	for (FBVHPoseBuffer& Pose : Poses)
+	{
+		Converter.InitPose(Pose);
+	}
+	FrontPose = 0;
+	FrameValues.SetNumZeroed(Hierarchy.NumChannels);
+	PoseTimestamp = 0.0;
+
+	Recording.Nodes = Hierarchy.Nodes;
+	Recording.NumChannels = Hierarchy.NumChannels;
+
+	// Until the first frame arrives the pose is the rest pose
+	for (int32 NodeIndex = 0; NodeIndex < Hierarchy.Nodes.Num(); ++NodeIndex)
+	{
+		Poses[FrontPose].LocalTransforms[NodeIndex] = FTransform(ConvertPos(Hierarchy.Nodes[NodeIndex].Offset));
+	}
+
+	FBVHLiveStreamSettings Settings;
+	Settings.Protocol = bUseUdp ? EBVHLiveProtocol::Udp : EBVHLiveProtocol::Tcp;
+	Settings.Host = Host;
+	Settings.Port = Port;
+	Settings.NumLeadingTokens = NumLeadingTokens;
+	Settings.RingCapacity = RingCapacity;
+
+	Stream = MakeUnique<FBVHLiveStream>(Hierarchy.NumChannels, Settings);
+	if (!Stream->Start())
+	{
+		Stream.Reset();
+		return false;
+	}
+	return true;
+}
+
+void UBVHLiveStreamComponent::Disconnect()
+{
+	if (Stream)
+	{
+		Stream->Shutdown();
+		UE_LOG(LogBVHRuntime, Log, TEXT("BVHLiveStream: Closed, %d frames dropped, %d lines skipped"),
+			Stream->GetFrames().GetNumDropped(), Stream->GetNumMalformedLines());
+		Stream.Reset();
+	}
+}
+
+bool UBVHLiveStreamComponent::IsConnected() const
+{
+	return Stream && Stream->IsConnected();
+}
+
+void UBVHLiveStreamComponent::StartRecording()
+{
+	Recording.MotionData.Reset();
+	Recording.NumFrames = 0;
+	Recording.FrameTime = 0.0;
+	bRecording = true;
+}
+
+void UBVHLiveStreamComponent::StopRecording()
+{
+	bRecording = false;
+	if (Recording.NumFrames > 1)
+	{
+		Recording.FrameTime = (RecordingLastTime - RecordingStartTime) / (Recording.NumFrames - 1);
+	}
+}
+
+void UBVHLiveStreamComponent::AddPoseReader(UActorComponent* Reader)
+{
+	if (Reader && Reader != this)
+	{
+		Reader->PrimaryComponentTick.AddPrerequisite(this, PrimaryComponentTick);
+	}
+}
+
+void UBVHLiveStreamComponent::BeginPlay()
+{
+	Super::BeginPlay();
+	if (AActor* Owner = GetOwner())
+	{
+		TInlineComponentArray<USkeletalMeshComponent*> Meshes(Owner);
+		for (USkeletalMeshComponent* Mesh : Meshes)
+		{
+			AddPoseReader(Mesh);
+		}
+	}
+
+	if (bConnectOnBeginPlay && !HierarchyFile.FilePath.IsEmpty())
+	{
+		Connect();
+	}
+}
+
+void UBVHLiveStreamComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Disconnect();
+	Super::EndPlay(EndPlayReason);
+}
+
+void UBVHLiveStreamComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	if (!Stream)
+	{
+		return;
+	}
+
+	FBVHFrameRing& Frames = Stream->GetFrames();
+	bool bHasFrame = false;
+	double Timestamp = 0.0;
+	if (bRecording)
+	{
+		// Every frame is kept, the pose still ends on the newest one
+		double FrameTimestamp = 0.0;
+		while (Frames.Pop(FrameValues, FrameTimestamp))
+		{
+			if (Recording.NumFrames == 0)
+			{
+				RecordingStartTime = FrameTimestamp;
+			}
+			RecordingLastTime = FrameTimestamp;
+			Recording.MotionData.Append(FrameValues);
+			++Recording.NumFrames;
+			Timestamp = FrameTimestamp;
+			bHasFrame = true;
+		}
+	}
+	else
+	{
+		bHasFrame = Frames.PopLatest(FrameValues, Timestamp);
+	}
+
+	if (bHasFrame)
+	{
+		// Readers keep the front buffer while the back one is written
+		const int32 BackPose = 1 - FrontPose;
+		Converter.EvaluatePose(FrameValues, Poses[BackPose]);
+		FrontPose = BackPose;
+		PoseTimestamp = Timestamp;
+	}
+}
@@ -0,0 +1,1321 @@
+#include "BVHParser.h"
+#include "Async/MappedFileHandle.h"
+#include "Async/ParallelFor.h"
+#include "BVHRuntimeLog.h"
+#include "BVHTokenizer.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include <atomic>
+
+namespace
+{
+	FString TokenToString(FAnsiStringView Token)
+	{
+		FUTF8ToTCHAR Converted(Token.GetData(), Token.Len());
+		return FString(Converted.Length(), Converted.Get());
+	}
+
+	// Joint names are interned once at parse time, consumers compare and hash them as FNames
+	FName NameFromToken(FAnsiStringView Token)
+	{
+		FUTF8ToTCHAR Converted(Token.GetData(), Token.Len());
+		return FName(Converted.Length(), Converted.Get());
+	}
+
+	// Accepts "{" either at the end of the current line or as the next token
+	bool ConsumeOpenBrace(FBVHTokenizer& Tokenizer)
+	{
+		FAnsiStringView Token;
+		while (Tokenizer.NextTokenOnLine(Token))
+		{
+			if (FBVHTokenizer::Matches(Token, "{"))
+			{
+				return true;
+			}
+		}
+		return Tokenizer.NextToken(Token) && FBVHTokenizer::Matches(Token, "{");
+	}
+
+	void ParseOffsetTokens(FBVHTokenizer& Tokenizer, FVector3d& OutOffset)
+	{
+		FAnsiStringView X, Y, Z;
+		if (Tokenizer.NextTokenOnLine(X) && Tokenizer.NextTokenOnLine(Y) && Tokenizer.NextTokenOnLine(Z))
+		{
+			OutOffset.X = FBVHTokenizer::ToDouble(X);
+			OutOffset.Y = FBVHTokenizer::ToDouble(Y);
+			OutOffset.Z = FBVHTokenizer::ToDouble(Z);
+		}
+	}
+
+	bool ParseFrameTokens(FBVHTokenizer& Tokenizer, double* OutValues, int32 NumChannels, int32 FrameIndex)
+	{
+		FAnsiStringView Token;
+		for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+		{
+			if (!Tokenizer.NextTokenOnLine(Token))
+			{
+				UE_LOG(LogBVHRuntime, Error, TEXT("BVHParser: Frame %d has fewer than %d values"), FrameIndex, NumChannels);
+				return false;
+			}
+			OutValues[Channel] = FBVHTokenizer::ToDouble(Token);
+		}
+
+		// Trailing values beyond the hierarchy's channel count are ignored
+		Tokenizer.SkipLine();
+		return true;
+	}
+
+	// Motion blocks smaller than this parse faster on one thread than the split costs
+	constexpr int64 MinBytesForParallelMotion = 1 << 20;
+
+	// Counts the lines holding a frame, which are exactly the lines the serial loop parses:
+	// whitespace, blank lines included, is skipped and any other character starts a frame
+	int32 CountFrameLines(const ANSICHAR* Cursor, const ANSICHAR* End)
+	{
+		int32 NumLines = 0;
+		while (Cursor < End)
+		{
+			while (Cursor < End && FBVHTokenizer::IsWhitespace(*Cursor))
+			{
+				++Cursor;
+			}
+			if (Cursor >= End)
+			{
+				break;
+			}
+
+			++NumLines;
+			const void* Break = memchr(Cursor, '\n', End - Cursor);
+			Cursor = Break ? static_cast<const ANSICHAR*>(Break) + 1 : End;
+		}
+		return NumLines;
+	}
+
+	void TransposeBlocked(const double* Source, double* Dest, int32 NumRows, int32 NumColumns)
+	{
+		constexpr int32 BlockSize = 32;
+		for (int32 RowBlock = 0; RowBlock < NumRows; RowBlock += BlockSize)
+		{
+			const int32 RowEnd = FMath::Min(RowBlock + BlockSize, NumRows);
+			for (int32 ColumnBlock = 0; ColumnBlock < NumColumns; ColumnBlock += BlockSize)
+			{
+				const int32 ColumnEnd = FMath::Min(ColumnBlock + BlockSize, NumColumns);
+				for (int32 Row = RowBlock; Row < RowEnd; ++Row)
+				{
+					for (int32 Column = ColumnBlock; Column < ColumnEnd; ++Column)
+					{
+						Dest[(int64)Column * NumRows + Row] = Source[(int64)Row * NumColumns + Column];
+					}
+				}
+			}
+		}
+	}
+
+	// Channel names are all nine characters, axis letter first, then "position" or "rotation".
+	// The axis and the second letter index the table directly and one compare confirms the name.
+	EBVHChannel ChannelFromToken(FAnsiStringView Token)
+	{
+		struct FChannelName
+		{
+			const ANSICHAR* Text;
+			EBVHChannel Channel;
+		};
+		static constexpr FChannelName ChannelNames[] =
+		{
+			{ "Xposition", EBVHChannel::Xposition },
+			{ "Yposition", EBVHChannel::Yposition },
+			{ "Zposition", EBVHChannel::Zposition },
+			{ "Xrotation", EBVHChannel::Xrotation },
+			{ "Yrotation", EBVHChannel::Yrotation },
+			{ "Zrotation", EBVHChannel::Zrotation },
+		};
+		constexpr int32 NameLen = 9;
+
+		if (Token.Len() != NameLen || Token[0] < 'X' || Token[0] > 'Z')
+		{
+			return EBVHChannel::Unknown;
+		}
+
+		const FChannelName& Entry = ChannelNames[(Token[0] - 'X') + (Token[1] == 'r' ? 3 : 0)];
+		return FMemory::Memcmp(Token.GetData(), Entry.Text, NameLen) == 0 ? Entry.Channel : EBVHChannel::Unknown;
+	}
+
+	enum class EBVHKeyword : uint8
+	{
+		Unknown,
+		CloseBrace,
+		Offset,
+		Channels,
+		Joint,
+		EndSite
+	};
+
+	struct FKeywordEntry
+	{
+		const ANSICHAR* Text;
+		int32 Len;
+		EBVHKeyword Keyword;
+	};
+
+	constexpr FKeywordEntry Keywords[] =
+	{
+		{ "}", 1, EBVHKeyword::CloseBrace },
+		{ "OFFSET", 6, EBVHKeyword::Offset },
+		{ "CHANNELS", 8, EBVHKeyword::Channels },
+		{ "JOINT", 5, EBVHKeyword::Joint },
+		{ "End", 3, EBVHKeyword::EndSite },
+	};
+
+	// First character plus length is a perfect hash over the hierarchy keywords
+	constexpr uint32 NumKeywordSlots = 16;
+	constexpr uint32 KeywordSlot(ANSICHAR First, int32 Len)
+	{
+		return (uint32(uint8(First)) + uint32(Len)) & (NumKeywordSlots - 1);
+	}
+
+	struct FKeywordTable
+	{
+		uint8 Slots[NumKeywordSlots] = {}; // Index into Keywords plus one, zero for an empty slot
+		bool bPerfect = true;
+	};
+
+	constexpr FKeywordTable MakeKeywordTable()
+	{
+		FKeywordTable Table;
+		for (int32 Index = 0; Index < (int32)UE_ARRAY_COUNT(Keywords); ++Index)
+		{
+			uint8& Slot = Table.Slots[KeywordSlot(Keywords[Index].Text[0], Keywords[Index].Len)];
+			Table.bPerfect &= Slot == 0;
+			Slot = uint8(Index + 1);
+		}
+		return Table;
+	}
+
+	constexpr FKeywordTable KeywordTable = MakeKeywordTable();
+	static_assert(KeywordTable.bPerfect, "Hierarchy keywords collide in KeywordSlot");
+
+	EBVHKeyword KeywordFromToken(FAnsiStringView Token)
+	{
+		if (Token.Len() == 0)
+		{
+			return EBVHKeyword::Unknown;
+		}
+
+		const uint8 Slot = KeywordTable.Slots[KeywordSlot(Token[0], Token.Len())];
+		if (Slot == 0)
+		{
+			return EBVHKeyword::Unknown;
+		}
+
+		const FKeywordEntry& Entry = Keywords[Slot - 1];
+		return Entry.Len == Token.Len() && FMemory::Memcmp(Token.GetData(), Entry.Text, Entry.Len) == 0
+			? Entry.Keyword : EBVHKeyword::Unknown;
+	}
+}
+
+void FBVHData::ConvertToLayout(EBVHMotionLayout NewLayout)
+{
+	if (NewLayout == Layout)
+	{
+		return;
+	}
+
+	TArray<double> Reordered;
+	Reordered.SetNumUninitialized(MotionData.Num());
+	if (Layout == EBVHMotionLayout::FrameMajor)
+	{
+		TransposeBlocked(MotionData.GetData(), Reordered.GetData(), NumFrames, NumChannels);
+	}
+	else
+	{
+		TransposeBlocked(MotionData.GetData(), Reordered.GetData(), NumChannels, NumFrames);
+	}
+
+	MotionData = MoveTemp(Reordered);
+	Layout = NewLayout;
+}
+
+FBVHParser::FBVHParser(const FString& InFilename, const FBVHParseOptions& InOptions)
+	: Filename(InFilename)
+	, Options(InOptions)
+	, CurrentLineIndex(0)
+{
+}
+
+// Source frames a parse keeps, from the options' frame window clamped to the header's frame count
+struct FBVHParser::FFrameWindow
+{
+	int32 First = 0;
+	int32 End = MAX_int32; // Exclusive, in source frames
+	int32 Stride = 1;
+	int32 NumDeclaredFrames = 0;
+
+	FFrameWindow(const FBVHParseOptions& Options, int32 InNumDeclaredFrames)
+		: First(FMath::Max(Options.FirstFrame, 0))
+		, Stride(FMath::Max(Options.FrameStride, 1))
+		, NumDeclaredFrames(InNumDeclaredFrames)
+	{
+		if (Options.NumFrames >= 0)
+		{
+			End = (int32)FMath::Min<int64>((int64)First + Options.NumFrames, MAX_int32);
+		}
+		if (NumDeclaredFrames > 0)
+		{
+			End = FMath::Min(End, NumDeclaredFrames);
+		}
+	}
+
+	bool Keeps(int32 SourceFrame) const
+	{
+		return SourceFrame >= First && (SourceFrame - First) % Stride == 0;
+	}
+
+	/** Frames kept when the take is as long as declared, 0 when neither bounds the window */
+	int32 GetNumKept() const
+	{
+		return End == MAX_int32 || End <= First ? 0 : (End - First + Stride - 1) / Stride;
+	}
+};
+
+bool FBVHParser::Parse(FBVHData& OutData)
+{
+	const bool bParsed = Options.Mode == EBVHParseMode::Tokenized ? ParseTokenized(OutData) : ParseLines(OutData);
+	if (bParsed && OutData.Layout != Options.Layout)
+	{
+		OutData.ConvertToLayout(Options.Layout);
+	}
+	return bParsed;
+}
+
+bool FBVHParser::ParseLines(FBVHData& OutData)
+{
+	{
+		BVH_SCOPE_CYCLE_COUNTER(STAT_BVHFileLoad);
+		if (!FFileHelper::LoadFileToStringArray(Lines, *Filename))
+		{
+			return false;
+		}
+	}
+
+	CurrentLineIndex = 0;
+	FString Line;
+	
+	// Expect HIERARCHY
+	if (!ReadLine(Line) || Line.TrimStartAndEnd() != TEXT("HIERARCHY"))
+	{
+		return false;
+	}
+
+	{
+		BVH_SCOPE_CYCLE_COUNTER(STAT_BVHHierarchyParse);
+		if (!ParseHierarchy(OutData.Nodes))
+		{
+			return false;
+		}
+	}
+
+	OutData.NumChannels = AssignChannelIndices(OutData.Nodes);
+
+	// Find MOTION section
+	// ParseHierarchy may consume lines up to the end of HIERARCHY block
+	while (CurrentLineIndex < Lines.Num())
+	{
+		if (Lines[CurrentLineIndex].TrimStartAndEnd() == TEXT("MOTION"))
+		{
+			CurrentLineIndex++;
+			break;
+		}
+		CurrentLineIndex++;
+	}
+
+	if (CurrentLineIndex >= Lines.Num())
+	{
+		return false;
+	}
+
+	return ParseMotion(OutData);
+}
+
+bool FBVHParser::ParseHierarchy(TArray<FBVHNode>& OutNodes)
+{
+	FString Line;
+	if (!ReadLine(Line)) return false;
+
+	FString Token = GetNextToken(Line);
+	if (Token != TEXT("ROOT"))
+	{
+		UE_LOG(LogBVHRuntime, Error, TEXT("BVHParser: Expected ROOT, found '%s'"), *Token);
+		return false;
+	}
+
+	OutNodes.Reset();
+	return ParseNode(OutNodes, INDEX_NONE);
+}
+
+bool FBVHParser::ParseNode(TArray<FBVHNode>& Nodes, int32 ParentIndex)
+{
+	// ParseHierarchy reads "ROOT", gets name, then calls ParseNodeContent
+	
+	FString CurrentLine = Lines[CurrentLineIndex - 1];
+	
+	TArray<FString> Tokens;
+	CurrentLine.ParseIntoArray(Tokens, TEXT(" "), true);
+	
+	// Children are appended behind the node, so it is always addressed by index
+	const int32 NodeIndex = AddNode(Nodes, Tokens.Num() >= 2 ? FName(*Tokens[1]) : FName(TEXT("Root")), ParentIndex);
+
+	FString Line;
+	if (!ReadLine(Line) || Line.TrimStartAndEnd() != TEXT("{"))
+	{
+		return false;
+	}
+
+	while (ReadLine(Line))
+	{
+		FString Trimmed = Line.TrimStartAndEnd();
+		if (Trimmed == TEXT("}"))
+		{
+			return true;
+		}
+		
+		if (Trimmed.StartsWith(TEXT("OFFSET")))
+		{
+			TArray<FString> Parts;
+			Trimmed.ParseIntoArray(Parts, TEXT(" "), true);
+			if (Parts.Num() >= 4)
+			{
+				Nodes[NodeIndex].Offset.X = FCString::Atod(*Parts[1]);
+				Nodes[NodeIndex].Offset.Y = FCString::Atod(*Parts[2]);
+				Nodes[NodeIndex].Offset.Z = FCString::Atod(*Parts[3]);
+			}
+		}
+		else if (Trimmed.StartsWith(TEXT("CHANNELS")))
+		{
+			FBVHNode& Node = Nodes[NodeIndex];
+			TArray<FString> Parts;
+			Trimmed.ParseIntoArray(Parts, TEXT(" "), true);
+			for (int32 i = 2; i < Parts.Num(); ++i)
+			{
+				FString Chan = Parts[i];
+				if (Chan == TEXT("Xposition")) Node.Channels.Add(EBVHChannel::Xposition);
+				else if (Chan == TEXT("Yposition")) Node.Channels.Add(EBVHChannel::Yposition);
+				else if (Chan == TEXT("Zposition")) Node.Channels.Add(EBVHChannel::Zposition);
+				else if (Chan == TEXT("Zrotation")) Node.Channels.Add(EBVHChannel::Zrotation);
+				else if (Chan == TEXT("Xrotation")) Node.Channels.Add(EBVHChannel::Xrotation);
+				else if (Chan == TEXT("Yrotation")) Node.Channels.Add(EBVHChannel::Yrotation);
+				else Node.Channels.Add(EBVHChannel::Unknown);
+			}
+			ResolveChannelLayout(Node);
+		}
+		else if (Trimmed.StartsWith(TEXT("JOINT")))
+		{
+			if (!ParseNode(Nodes, NodeIndex))
+			{
+				return false;
+			}
+		}
+		else if (Trimmed.StartsWith(TEXT("End Site")))
+		{
+			// Treat End Site as a child node with no channels
+			const int32 EndIndex = AddNode(Nodes, FName(*(Nodes[NodeIndex].Name.ToString() + TEXT("_End"))), NodeIndex);
+			
+			if (!ReadLine(Line) || Line.TrimStartAndEnd() != TEXT("{")) return false;
+			
+			while (ReadLine(Line))
+			{
+				FString EndTrimmed = Line.TrimStartAndEnd();
+				if (EndTrimmed == TEXT("}")) break;
+				
+				if (EndTrimmed.StartsWith(TEXT("OFFSET")))
+				{
+					TArray<FString> Parts;
+					EndTrimmed.ParseIntoArray(Parts, TEXT(" "), true);
+					if (Parts.Num() >= 4)
+					{
+						Nodes[EndIndex].Offset.X = FCString::Atod(*Parts[1]);
+						Nodes[EndIndex].Offset.Y = FCString::Atod(*Parts[2]);
+						Nodes[EndIndex].Offset.Z = FCString::Atod(*Parts[3]);
+					}
+				}
+			}
+		}
+	}
+	
+	return true;
+}
+
+bool FBVHParser::ParseMotion(FBVHData& OutData)
+{
+	BVH_SCOPE_CYCLE_COUNTER(STAT_BVHMotionParse);
+	FString Line;
+	
+	// Parse Frames count
+	if (!ReadLine(Line)) return false;
+	if (Line.TrimStartAndEnd().StartsWith(TEXT("Frames:")))
+	{
+		FString Val = Line.Replace(TEXT("Frames:"), TEXT("")).TrimStartAndEnd();
+		OutData.NumFrames = FCString::Atoi(*Val);
+	}
+	
+	// Parse Frame Time
+	if (!ReadLine(Line)) return false;
+	if (Line.TrimStartAndEnd().StartsWith(TEXT("Frame Time:")))
+	{
+		FString Val = Line.Replace(TEXT("Frame Time:"), TEXT("")).TrimStartAndEnd();
+		OutData.FrameTime = FCString::Atod(*Val);
+	}
+	
+	// Parse Motion Data
+	const FFrameWindow Window(Options, OutData.NumFrames);
+	OutData.Layout = EBVHMotionLayout::FrameMajor;
+	OutData.MotionData.Reset();
+	OutData.MotionData.Reserve((int32)FMath::Min((int64)(Options.HasFrameWindow() ? Window.GetNumKept() : OutData.NumFrames) * OutData.NumChannels, (int64)MAX_int32));
+	int32 NumSourceFrames = 0;
+	int32 NumParsedFrames = 0;
+	while (NumSourceFrames < Window.End && ReadLine(Line))
+	{
+		TArray<FString> Parts;
+		// Handle tabs and spaces
+		Line = Line.Replace(TEXT("\t"), TEXT(" "));
+		Line.ParseIntoArray(Parts, TEXT(" "), true);
+		
+		if (Parts.Num() == 0) continue;
+
+		if (!Window.Keeps(NumSourceFrames++)) continue;
+
+		// The original parser kept ragged frames as they came. The flat motion block has no place for a short
+		// frame, so it fails the parse here just like the tokenized path does.
+		if (Parts.Num() < OutData.NumChannels)
+		{
+			UE_LOG(LogBVHRuntime, Error, TEXT("BVHParser: Frame %d has fewer than %d values"), NumParsedFrames, OutData.NumChannels);
+			return false;
+		}
+		
+		for (int32 Channel = 0; Channel < OutData.NumChannels; ++Channel)
+		{
+			OutData.MotionData.Add(FCString::Atod(*Parts[Channel]));
+		}
+		++NumParsedFrames;
+	}
+
+	FinishWindowedMotion(OutData, Window, NumSourceFrames, NumParsedFrames);
+	OutData.FrameTime *= Window.Stride;
+	return true;
+}
+
+void FBVHParser::FinishMotion(FBVHData& OutData, int32 NumParsedFrames) const
+{
+	if (NumParsedFrames < OutData.NumFrames)
+	{
+		UE_LOG(LogBVHRuntime, Warning, TEXT("BVHParser: %s declares %d frames but only %d were found"), *Filename, OutData.NumFrames, NumParsedFrames);
+	}
+	OutData.NumFrames = NumParsedFrames;
+}
+
+void FBVHParser::FinishWindowedMotion(FBVHData& OutData, const FFrameWindow& Window, int32 NumSourceFrames, int32 NumKeptFrames) const
+{
+	// The window end never lies past the declared count, so falling short of it means a short file
+	if (Window.NumDeclaredFrames > 0 && NumSourceFrames < Window.End)
+	{
+		UE_LOG(LogBVHRuntime, Warning, TEXT("BVHParser: %s declares %d frames but only %d were found"), *Filename, Window.NumDeclaredFrames, NumSourceFrames);
+	}
+	OutData.NumFrames = NumKeptFrames;
+}
+
+int32 FBVHParser::AssignChannelIndices(TArray<FBVHNode>& Nodes)
+{
+	// Motion values are laid out in depth-first hierarchy order, which is the order of Nodes
+	int32 NextChannelIndex = 0;
+	for (FBVHNode& Node : Nodes)
+	{
+		Node.ChannelStartIndex = NextChannelIndex;
+		NextChannelIndex += Node.Channels.Num();
+	}
+	return NextChannelIndex;
+}
+
+int32 FBVHParser::AddNode(TArray<FBVHNode>& Nodes, FName Name, int32 ParentIndex)
+{
+	const int32 NodeIndex = Nodes.AddDefaulted();
+	Nodes[NodeIndex].Name = Name;
+	Nodes[NodeIndex].ParentIndex = ParentIndex;
+	if (ParentIndex != INDEX_NONE)
+	{
+		++Nodes[ParentIndex].NumChildren;
+	}
+	return NodeIndex;
+}
+
+void FBVHParser::ResolveChannelLayout(FBVHNode& Node)
+{
+	Node.PositionMask = 0;
+	Node.RotationOrder = EBVHRotationOrder::None;
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Node.PositionChannels[Axis] = INDEX_NONE;
+		Node.RotationChannels[Axis] = INDEX_NONE;
+	}
+
+	// Channel indices must fit the int8 slots
+	if (Node.Channels.Num() > MAX_int8)
+	{
+		Node.RotationOrder = EBVHRotationOrder::Custom;
+		return;
+	}
+
+	int32 NumRotations = 0;
+	uint8 RotationMask = 0;
+	uint32 OrderKey = 0; // Axes packed two bits each, first channel highest
+	for (int32 i = 0; i < Node.Channels.Num(); ++i)
+	{
+		switch (Node.Channels[i])
+		{
+		case EBVHChannel::Xposition: Node.PositionChannels[0] = (int8)i; Node.PositionMask |= 1 << 0; break;
+		case EBVHChannel::Yposition: Node.PositionChannels[1] = (int8)i; Node.PositionMask |= 1 << 1; break;
+		case EBVHChannel::Zposition: Node.PositionChannels[2] = (int8)i; Node.PositionMask |= 1 << 2; break;
+		case EBVHChannel::Xrotation:
+		case EBVHChannel::Yrotation:
+		case EBVHChannel::Zrotation:
+		{
+			const uint32 Axis = Node.Channels[i] == EBVHChannel::Xrotation ? 0 : Node.Channels[i] == EBVHChannel::Yrotation ? 1 : 2;
+			if (NumRotations < 3)
+			{
+				Node.RotationChannels[NumRotations] = (int8)i;
+			}
+			++NumRotations;
+			RotationMask |= 1 << Axis;
+			OrderKey = (OrderKey << 2) | Axis;
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	if (NumRotations == 0)
+	{
+		return;
+	}
+
+	if (NumRotations != 3 || RotationMask != 0x7)
+	{
+		Node.RotationOrder = EBVHRotationOrder::Custom;
+		return;
+	}
+
+	switch (OrderKey)
+	{
+	case (0 << 4) | (1 << 2) | 2: Node.RotationOrder = EBVHRotationOrder::XYZ; break;
+	case (0 << 4) | (2 << 2) | 1: Node.RotationOrder = EBVHRotationOrder::XZY; break;
+	case (1 << 4) | (0 << 2) | 2: Node.RotationOrder = EBVHRotationOrder::YXZ; break;
+	case (1 << 4) | (2 << 2) | 0: Node.RotationOrder = EBVHRotationOrder::YZX; break;
+	case (2 << 4) | (0 << 2) | 1: Node.RotationOrder = EBVHRotationOrder::ZXY; break;
+	case (2 << 4) | (1 << 2) | 0: Node.RotationOrder = EBVHRotationOrder::ZYX; break;
+	default: Node.RotationOrder = EBVHRotationOrder::Custom; break;
+	}
+}
+
+bool FBVHParser::ParseTokenized(FBVHData& OutData)
+{
+	// The tokenizer runs over the mapped bytes in place, a loaded copy is only the fallback
+	// for platforms or files that cannot be mapped. The region is released before the handle.
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	TArray<uint8> FileBytes;
+	const uint8* Bytes = nullptr;
+	int64 NumBytes = 0;
+
+	{
+		BVH_SCOPE_CYCLE_COUNTER(STAT_BVHFileLoad);
+		if (Options.bMemoryMapped)
+		{
+			FOpenMappedResult Mapped = FPlatformFileManager::Get().GetPlatformFile().OpenMappedEx(*Filename);
+			if (Mapped.HasValue() && Mapped.GetValue()->GetFileSize() > 0)
+			{
+				MappedFile = Mapped.StealValue();
+				MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+			}
+		}
+
+		if (MappedRegion)
+		{
+			Bytes = MappedRegion->GetMappedPtr();
+			NumBytes = MappedRegion->GetMappedSize();
+		}
+		else
+		{
+			if (!FFileHelper::LoadFileToArray(FileBytes, *Filename))
+			{
+				return false;
+			}
+			Bytes = FileBytes.GetData();
+			NumBytes = FileBytes.Num();
+		}
+	}
+
+	// UTF-16 files still go through the line based path, which converts them on load. Options stay as the
+	// caller set them, so the next file through this parser is tokenized again.
+	if (NumBytes >= 2 && ((Bytes[0] == 0xFF && Bytes[1] == 0xFE) || (Bytes[0] == 0xFE && Bytes[1] == 0xFF)))
+	{
+		return ParseLines(OutData);
+	}
+
+	const ANSICHAR* Begin = reinterpret_cast<const ANSICHAR*>(Bytes);
+	const ANSICHAR* End = Begin + NumBytes;
+
+	// Skip UTF-8 BOM
+	if (NumBytes >= 3 && Bytes[0] == 0xEF && Bytes[1] == 0xBB && Bytes[2] == 0xBF)
+	{
+		Begin += 3;
+	}
+
+	FBVHTokenizer Tokenizer(Begin, End);
+	if (!ParseHeaderTokens(Tokenizer, OutData))
+	{
+		return false;
+	}
+	return ParseMotionTokens(Tokenizer, OutData);
+}
+
+bool FBVHParser::ParseHeaderTokens(FBVHTokenizer& Tokenizer, FBVHData& OutData)
+{
+	BVH_SCOPE_CYCLE_COUNTER(STAT_BVHHierarchyParse);
+	FAnsiStringView Token;
+
+	// Expect HIERARCHY
+	if (!Tokenizer.NextToken(Token) || !FBVHTokenizer::Matches(Token, "HIERARCHY"))
+	{
+		return false;
+	}
+
+	if (!Tokenizer.NextToken(Token) || !FBVHTokenizer::Matches(Token, "ROOT"))
+	{
+		UE_LOG(LogBVHRuntime, Error, TEXT("BVHParser: Expected ROOT, found '%s'"), *TokenToString(Token));
+		return false;
+	}
+
+	OutData.Nodes.Reset();
+	if (!ParseHierarchyTokens(Tokenizer, OutData.Nodes))
+	{
+		return false;
+	}
+
+	OutData.NumChannels = AssignChannelIndices(OutData.Nodes);
+
+	// Find MOTION section
+	bool bFoundMotion = false;
+	while (Tokenizer.NextToken(Token))
+	{
+		if (FBVHTokenizer::Matches(Token, "MOTION"))
+		{
+			bFoundMotion = true;
+			break;
+		}
+	}
+
+	if (!bFoundMotion)
+	{
+		return false;
+	}
+
+	Tokenizer.SkipLine();
+	return ParseMotionHeaderTokens(Tokenizer, OutData);
+}
+
+bool FBVHParser::ParseHierarchyTokens(FBVHTokenizer& Tokenizer, TArray<FBVHNode>& Nodes)
+{
+	// Open joints and end sites are tracked on an explicit stack, so nesting depth is bounded by memory
+	// rather than the call stack. Children are appended behind their parent, nodes are always addressed by index.
+	struct FOpenNode
+	{
+		int32 NodeIndex;
+		bool bEndSite;
+	};
+	TArray<FOpenNode, TInlineAllocator<64>> OpenNodes;
+
+	// The ROOT/JOINT keyword has been consumed, the name follows on the same line
+	auto BeginNode = [&Tokenizer, &Nodes, &OpenNodes](int32 ParentIndex)
+	{
+		FAnsiStringView Token;
+		if (Tokenizer.NextTokenOnLine(Token) && !FBVHTokenizer::Matches(Token, "{"))
+		{
+			OpenNodes.Add({ AddNode(Nodes, NameFromToken(Token), ParentIndex), false });
+			return ConsumeOpenBrace(Tokenizer);
+		}
+
+		OpenNodes.Add({ AddNode(Nodes, FName(TEXT("Root")), ParentIndex), false });
+		return Token.Len() > 0 || ConsumeOpenBrace(Tokenizer);
+	};
+
+	if (!BeginNode(INDEX_NONE))
+	{
+		return false;
+	}
+
+	FAnsiStringView Token;
+	while (OpenNodes.Num() > 0 && Tokenizer.NextToken(Token))
+	{
+		const FOpenNode Top = OpenNodes.Last();
+		const EBVHKeyword Keyword = KeywordFromToken(Token);
+
+		if (Keyword == EBVHKeyword::CloseBrace)
+		{
+			OpenNodes.Pop(EAllowShrinking::No);
+		}
+		else if (Keyword == EBVHKeyword::Offset)
+		{
+			ParseOffsetTokens(Tokenizer, Nodes[Top.NodeIndex].Offset);
+		}
+		else if (Top.bEndSite)
+		{
+			// End sites only carry an offset
+			Tokenizer.SkipLine();
+		}
+		else if (Keyword == EBVHKeyword::Channels)
+		{
+			// Channel count is implied by the names that follow on the line
+			FBVHNode& Node = Nodes[Top.NodeIndex];
+			Tokenizer.NextTokenOnLine(Token);
+			while (Tokenizer.NextTokenOnLine(Token))
+			{
+				Node.Channels.Add(ChannelFromToken(Token));
+			}
+			ResolveChannelLayout(Node);
+		}
+		else if (Keyword == EBVHKeyword::Joint)
+		{
+			if (!BeginNode(Top.NodeIndex))
+			{
+				return false;
+			}
+		}
+		else if (Keyword == EBVHKeyword::EndSite)
+		{
+			// Treat End Site as a child node with no channels
+			TStringBuilder<NAME_SIZE> EndName;
+			Nodes[Top.NodeIndex].Name.AppendString(EndName);
+			EndName << TEXT("_End");
+			OpenNodes.Add({ AddNode(Nodes, FName(EndName.Len(), EndName.GetData()), Top.NodeIndex), true });
+
+			// Skips the "Site" keyword
+			if (!ConsumeOpenBrace(Tokenizer))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			Tokenizer.SkipLine();
+		}
+	}
+
+	return true;
+}
+
+bool FBVHParser::ParseMotionHeaderTokens(FBVHTokenizer& Tokenizer, FBVHData& OutData)
+{
+	FAnsiStringView Line;
+
+	// Parse Frames count
+	if (!Tokenizer.ReadLine(Line)) return false;
+	if (FBVHTokenizer::StartsWith(Line, "Frames:"))
+	{
+		OutData.NumFrames = FBVHTokenizer::ToInt(Line.RightChop(7));
+	}
+
+	// Parse Frame Time
+	if (!Tokenizer.ReadLine(Line)) return false;
+	if (FBVHTokenizer::StartsWith(Line, "Frame Time:"))
+	{
+		OutData.FrameTime = FBVHTokenizer::ToDouble(Line.RightChop(11));
+	}
+	return true;
+}
+
+bool FBVHParser::ParseMotionTokens(FBVHTokenizer& Tokenizer, FBVHData& OutData)
+{
+	BVH_SCOPE_CYCLE_COUNTER(STAT_BVHMotionParse);
+	// Size the buffer from the header, but never beyond what the remaining bytes could hold
+	const int32 NumChannels = OutData.NumChannels;
+	const int64 MaxValues = (Tokenizer.GetEnd() - Tokenizer.GetCursor()) / 2 + 1;
+	const int64 DeclaredValues = (int64)OutData.NumFrames * NumChannels;
+
+	OutData.MotionData.Reset();
+	if (Options.HasFrameWindow())
+	{
+		return ParseMotionTokensWindowed(Tokenizer, OutData);
+	}
+
+	if (Options.bParallelMotion && Tokenizer.GetEnd() - Tokenizer.GetCursor() >= MinBytesForParallelMotion)
+	{
+		return ParseMotionTokensParallel(Tokenizer, OutData);
+	}
+
+	if (Options.Layout == EBVHMotionLayout::ChannelMajor && OutData.NumFrames > 0 && DeclaredValues <= FMath::Min(MaxValues, (int64)MAX_int32))
+	{
+		return ParseMotionTokensChannelMajor(Tokenizer, OutData);
+	}
+
+	OutData.Layout = EBVHMotionLayout::FrameMajor;
+	OutData.MotionData.Reserve((int32)FMath::Min3(DeclaredValues, MaxValues, (int64)MAX_int32));
+
+	// Parse Motion Data, one frame per non-empty line
+	int32 NumParsedFrames = 0;
+	while (OutData.NumFrames <= 0 || NumParsedFrames < OutData.NumFrames)
+	{
+		Tokenizer.SkipWhitespace();
+		if (Tokenizer.IsAtEnd())
+		{
+			break;
+		}
+
+		const int32 FrameStart = OutData.MotionData.AddUninitialized(NumChannels);
+		if (!ParseFrameTokens(Tokenizer, OutData.MotionData.GetData() + FrameStart, NumChannels, NumParsedFrames))
+		{
+			return false;
+		}
+		++NumParsedFrames;
+	}
+
+	FinishMotion(OutData, NumParsedFrames);
+	return true;
+}
+
+bool FBVHParser::ParseMotionTokensParallel(FBVHTokenizer& Tokenizer, FBVHData& OutData)
+{
+	const ANSICHAR* Begin = Tokenizer.GetCursor();
+	const ANSICHAR* End = Tokenizer.GetEnd();
+	const int32 NumChannels = OutData.NumChannels;
+
+	// A few chunks per worker keeps the threads busy when line lengths vary across the take
+	const int64 NumBytes = End - Begin;
+	const int32 NumWorkers = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+	const int32 NumChunks = (int32)FMath::Clamp<int64>(NumBytes / (MinBytesForParallelMotion / 4), 1, NumWorkers * 4);
+
+	// Chunk boundaries always sit right after a line break, so no frame straddles two chunks
+	TArray<const ANSICHAR*, TInlineAllocator<256>> Boundaries;
+	Boundaries.Add(Begin);
+	for (int32 Chunk = 1; Chunk < NumChunks; ++Chunk)
+	{
+		const ANSICHAR* Target = FMath::Max(Begin + NumBytes * Chunk / NumChunks, Boundaries.Last());
+		const void* Break = Target < End ? memchr(Target, '\n', End - Target) : nullptr;
+		Boundaries.Add(Break ? static_cast<const ANSICHAR*>(Break) + 1 : End);
+	}
+	Boundaries.Add(End);
+
+	// Pre-count the frame lines per chunk, the prefix sums give every chunk its first frame index
+	TArray<int32, TInlineAllocator<256>> ChunkFirstFrame;
+	ChunkFirstFrame.SetNumZeroed(NumChunks + 1);
+	ParallelFor(NumChunks, [&Boundaries, &ChunkFirstFrame](int32 Chunk)
+	{
+		ChunkFirstFrame[Chunk + 1] = CountFrameLines(Boundaries[Chunk], Boundaries[Chunk + 1]);
+	});
+
+	for (int32 Chunk = 0; Chunk < NumChunks; ++Chunk)
+	{
+		ChunkFirstFrame[Chunk + 1] += ChunkFirstFrame[Chunk];
+	}
+
+	// Lines beyond the declared frame count are ignored, as in the serial path
+	const int32 NumCountedFrames = ChunkFirstFrame[NumChunks];
+	const int32 NumFrames = OutData.NumFrames > 0 ? FMath::Min(OutData.NumFrames, NumCountedFrames) : NumCountedFrames;
+	if ((int64)NumFrames * NumChannels > MAX_int32)
+	{
+		UE_LOG(LogBVHRuntime, Error, TEXT("BVHParser: %s has too many motion values (%d frames of %d channels)"), *Filename, NumFrames, NumChannels);
+		return false;
+	}
+
+	OutData.Layout = Options.Layout;
+	OutData.MotionData.SetNumUninitialized(NumFrames * NumChannels);
+	double* Values = OutData.MotionData.GetData();
+	const bool bChannelMajor = Options.Layout == EBVHMotionLayout::ChannelMajor;
+
+	std::atomic<bool> bFailed = false;
+	ParallelFor(NumChunks, [&](int32 Chunk)
+	{
+		const int32 LastFrame = FMath::Min(ChunkFirstFrame[Chunk + 1], NumFrames);
+		FBVHTokenizer ChunkTokenizer(Boundaries[Chunk], Boundaries[Chunk + 1]);
+		TArray<double, TInlineAllocator<512>> Row;
+		Row.SetNumUninitialized(NumChannels);
+
+		for (int32 Frame = ChunkFirstFrame[Chunk]; Frame < LastFrame; ++Frame)
+		{
+			if (bFailed.load(std::memory_order_relaxed))
+			{
+				return;
+			}
+
+			ChunkTokenizer.SkipWhitespace();
+			double* FrameValues = bChannelMajor ? Row.GetData() : Values + (int64)Frame * NumChannels;
+			if (!ParseFrameTokens(ChunkTokenizer, FrameValues, NumChannels, Frame))
+			{
+				bFailed = true;
+				return;
+			}
+
+			// Consecutive frames of a chunk fill the same cache lines of every track
+			if (bChannelMajor)
+			{
+				for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+				{
+					Values[(int64)Channel * NumFrames + Frame] = Row[Channel];
+				}
+			}
+		}
+	});
+
+	if (bFailed)
+	{
+		return false;
+	}
+
+	FinishMotion(OutData, NumFrames);
+	return true;
+}
+
+bool FBVHParser::ParseMotionTokensWindowed(FBVHTokenizer& Tokenizer, FBVHData& OutData)
+{
+	// Only kept frames are tokenized, every other line is passed over with a memchr for its break,
+	// so the cost follows the window rather than the file. Frames land row by row and Parse moves
+	// them to the requested layout afterwards.
+	const FFrameWindow Window(Options, OutData.NumFrames);
+	const int32 NumChannels = OutData.NumChannels;
+	const int64 MaxValues = (Tokenizer.GetEnd() - Tokenizer.GetCursor()) / 2 + 1;
+
+	OutData.Layout = EBVHMotionLayout::FrameMajor;
+	OutData.MotionData.Reserve((int32)FMath::Min3((int64)Window.GetNumKept() * NumChannels, MaxValues, (int64)MAX_int32));
+
+	int32 NumSourceFrames = 0;
+	int32 NumKeptFrames = 0;
+	while (NumSourceFrames < Window.End)
+	{
+		Tokenizer.SkipWhitespace();
+		if (Tokenizer.IsAtEnd())
+		{
+			break;
+		}
+
+		if (Window.Keeps(NumSourceFrames))
+		{
+			const int32 FrameStart = OutData.MotionData.AddUninitialized(NumChannels);
+			if (!ParseFrameTokens(Tokenizer, OutData.MotionData.GetData() + FrameStart, NumChannels, NumSourceFrames))
+			{
+				return false;
+			}
+			++NumKeptFrames;
+		}
+		else
+		{
+			Tokenizer.SkipLine();
+		}
+		++NumSourceFrames;
+	}
+
+	FinishWindowedMotion(OutData, Window, NumSourceFrames, NumKeptFrames);
+	OutData.FrameTime *= Window.Stride;
+	return true;
+}
+
+bool FBVHParser::ParseMotionTokensChannelMajor(FBVHTokenizer& Tokenizer, FBVHData& OutData)
+{
+	// Frames are staged row by row in a small block, then scattered into the per-channel tracks
+	// so every channel receives one contiguous run of values per block
+	constexpr int32 BlockFrames = 64;
+
+	const int32 NumChannels = OutData.NumChannels;
+	const int32 NumDeclaredFrames = OutData.NumFrames;
+	OutData.Layout = EBVHMotionLayout::ChannelMajor;
+	OutData.MotionData.SetNumUninitialized(NumDeclaredFrames * NumChannels);
+
+	TArray<double> Block;
+	Block.SetNumUninitialized(BlockFrames * NumChannels);
+
+	double* Tracks = OutData.MotionData.GetData();
+	auto FlushBlock = [&](int32 BlockStart, int32 NumBlockFrames)
+	{
+		for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+		{
+			double* Track = Tracks + (int64)Channel * NumDeclaredFrames + BlockStart;
+			const double* Source = Block.GetData() + Channel;
+			for (int32 Frame = 0; Frame < NumBlockFrames; ++Frame)
+			{
+				Track[Frame] = Source[Frame * NumChannels];
+			}
+		}
+	};
+
+	int32 NumParsedFrames = 0;
+	int32 NumBlockFrames = 0;
+	while (NumParsedFrames < NumDeclaredFrames)
+	{
+		Tokenizer.SkipWhitespace();
+		if (Tokenizer.IsAtEnd())
+		{
+			break;
+		}
+
+		if (!ParseFrameTokens(Tokenizer, Block.GetData() + NumBlockFrames * NumChannels, NumChannels, NumParsedFrames))
+		{
+			return false;
+		}
+		++NumParsedFrames;
+
+		if (++NumBlockFrames == BlockFrames)
+		{
+			FlushBlock(NumParsedFrames - NumBlockFrames, NumBlockFrames);
+			NumBlockFrames = 0;
+		}
+	}
+	FlushBlock(NumParsedFrames - NumBlockFrames, NumBlockFrames);
+
+	// Close the gaps left by frames the header promised but the file did not contain
+	if (NumParsedFrames < NumDeclaredFrames)
+	{
+		for (int32 Channel = 1; Channel < NumChannels; ++Channel)
+		{
+			FMemory::Memmove(Tracks + (int64)Channel * NumParsedFrames, Tracks + (int64)Channel * NumDeclaredFrames, NumParsedFrames * sizeof(double));
+		}
+		OutData.MotionData.SetNum(NumParsedFrames * NumChannels);
+	}
+
+	FinishMotion(OutData, NumParsedFrames);
+	return true;
+}
+
+bool FBVHParser::ParseStreaming(FBVHData& OutData, TFunctionRef<void(const FBVHData&)> OnHeader, TFunctionRef<bool(const FBVHMotionChunk&)> OnChunk)
+{
+	TUniquePtr<IFileHandle> File(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Filename));
+	if (!File)
+	{
+		return false;
+	}
+
+	const int64 FileSize = File->Size();
+	const int32 BlockSize = FMath::Max(Options.ReadBlockSize, 4096);
+	bool bReadFailed = false;
+
+	// Bytes read from disk but not consumed yet, at most one block plus a partial line
+	TArray<uint8> Pending;
+	auto ReadBlock = [&]() -> bool
+	{
+		BVH_SCOPE_CYCLE_COUNTER(STAT_BVHFileLoad);
+		const int64 Remaining = FileSize - File->Tell();
+		if (Remaining <= 0)
+		{
+			return false;
+		}
+
+		const int32 ReadSize = (int32)FMath::Min<int64>(Remaining, BlockSize);
+		const int32 Offset = Pending.AddUninitialized(ReadSize);
+		if (!File->Read(Pending.GetData() + Offset, ReadSize))
+		{
+			Pending.SetNum(Offset, EAllowShrinking::No);
+			bReadFailed = true;
+			return false;
+		}
+		return true;
+	};
+
+	ReadBlock();
+
+	// UTF-16 files need the converting loader, so they are parsed whole and handed out as a single chunk
+	if (Pending.Num() >= 2 && ((Pending[0] == 0xFF && Pending[1] == 0xFE) || (Pending[0] == 0xFE && Pending[1] == 0xFF)))
+	{
+		File.Reset();
+		Pending.Empty();
+		if (!ParseLines(OutData))
+		{
+			return false;
+		}
+		OutData.ConvertToLayout(EBVHMotionLayout::ChannelMajor);
+
+		OnHeader(OutData);
+		FBVHMotionChunk Chunk;
+		Chunk.NumFrames = OutData.NumFrames;
+		Chunk.NumChannels = OutData.NumChannels;
+		Chunk.Values = OutData.MotionData;
+		const bool bContinue = Chunk.NumFrames == 0 || OnChunk(Chunk);
+		OutData.MotionData.Empty();
+		return bContinue;
+	}
+
+	// Buffer blocks until the header, which ends with the "Frame Time:" line, is complete
+	int32 HeaderEnd = INDEX_NONE;
+	int32 SearchFrom = 0;
+	while (HeaderEnd == INDEX_NONE)
+	{
+		const FAnsiStringView Buffered(reinterpret_cast<const ANSICHAR*>(Pending.GetData()), Pending.Num());
+		const int32 FrameTimePos = Buffered.Find("Frame Time:", SearchFrom, ESearchCase::CaseSensitive);
+		int32 LineEnd = INDEX_NONE;
+		if (FrameTimePos != INDEX_NONE && Buffered.RightChop(FrameTimePos).FindChar('\n', LineEnd))
+		{
+			HeaderEnd = FrameTimePos + LineEnd + 1;
+		}
+		else
+		{
+			// Rescan only the tail, which may hold the start of a split keyword
+			SearchFrom = FrameTimePos != INDEX_NONE ? FrameTimePos : FMath::Max(0, Buffered.Len() - 10);
+			if (!ReadBlock())
+			{
+				HeaderEnd = Pending.Num();
+			}
+		}
+	}
+
+	const ANSICHAR* Bytes = reinterpret_cast<const ANSICHAR*>(Pending.GetData());
+	const int32 BomSize = Pending.Num() >= 3 && Pending[0] == 0xEF && Pending[1] == 0xBB && Pending[2] == 0xBF ? 3 : 0;
+	FBVHTokenizer HeaderTokenizer(Bytes + BomSize, Bytes + HeaderEnd);
+	if (bReadFailed || !ParseHeaderTokens(HeaderTokenizer, OutData))
+	{
+		return false;
+	}
+
+	// Consumers see the window's frame count and rate from the start
+	const FFrameWindow Window(Options, OutData.NumFrames);
+	if (Options.HasFrameWindow())
+	{
+		OutData.NumFrames = Window.GetNumKept();
+		OutData.FrameTime *= Window.Stride;
+	}
+
+	OutData.Layout = EBVHMotionLayout::ChannelMajor;
+	OutData.MotionData.Reset();
+	OnHeader(OutData);
+	Pending.RemoveAt(0, UE_PTRDIFF_TO_INT32(HeaderTokenizer.GetCursor() - Bytes), EAllowShrinking::No);
+
+	// Frames are staged row by row, then transposed so the consumer sees channel-major tracks
+	const int32 NumChannels = OutData.NumChannels;
+	const int32 ChunkFrames = FMath::Max(Options.ChunkFrames, 1);
+	TArray<double> Rows;
+	TArray<double> Tracks;
+	Rows.SetNumUninitialized(ChunkFrames * NumChannels);
+	Tracks.SetNumUninitialized(ChunkFrames * NumChannels);
+
+	int32 NumSourceFrames = 0;
+	int32 NumParsedFrames = 0;
+	int32 NumChunkFrames = 0;
+	auto FlushChunk = [&]() -> bool
+	{
+		if (NumChunkFrames == 0)
+		{
+			return true;
+		}
+
+		TransposeBlocked(Rows.GetData(), Tracks.GetData(), NumChunkFrames, NumChannels);
+		FBVHMotionChunk Chunk;
+		Chunk.FirstFrame = NumParsedFrames - NumChunkFrames;
+		Chunk.NumFrames = NumChunkFrames;
+		Chunk.NumChannels = NumChannels;
+		Chunk.Values = TConstArrayView<double>(Tracks.GetData(), NumChunkFrames * NumChannels);
+		NumChunkFrames = 0;
+		return OnChunk(Chunk);
+	};
+
+	bool bEndOfFile = File->Tell() >= FileSize;
+	while (NumSourceFrames < Window.End)
+	{
+		// Conversion of each flushed chunk shows up nested under this scope
+		BVH_SCOPE_CYCLE_COUNTER(STAT_BVHMotionParse);
+
+		// Only complete lines are tokenized, a partial last line waits for the next block
+		Bytes = reinterpret_cast<const ANSICHAR*>(Pending.GetData());
+		int32 CompleteBytes = Pending.Num();
+		int32 LastBreak = INDEX_NONE;
+		if (!bEndOfFile)
+		{
+			CompleteBytes = FAnsiStringView(Bytes, Pending.Num()).FindLastChar('\n', LastBreak) ? LastBreak + 1 : 0;
+		}
+
+		FBVHTokenizer Tokenizer(Bytes, Bytes + CompleteBytes);
+		while (NumSourceFrames < Window.End)
+		{
+			Tokenizer.SkipWhitespace();
+			if (Tokenizer.IsAtEnd())
+			{
+				break;
+			}
+
+			// Lines outside the window only cost the scan for their line break
+			if (!Window.Keeps(NumSourceFrames++))
+			{
+				Tokenizer.SkipLine();
+				continue;
+			}
+
+			if (!ParseFrameTokens(Tokenizer, Rows.GetData() + NumChunkFrames * NumChannels, NumChannels, NumParsedFrames))
+			{
+				return false;
+			}
+			++NumParsedFrames;
+
+			if (++NumChunkFrames == ChunkFrames && !FlushChunk())
+			{
+				return false;
+			}
+		}
+		Pending.RemoveAt(0, UE_PTRDIFF_TO_INT32(Tokenizer.GetCursor() - Bytes), EAllowShrinking::No);
+
+		if (bEndOfFile)
+		{
+			break;
+		}
+		bEndOfFile = !ReadBlock();
+	}
+
+	if (!FlushChunk())
+	{
+		return false;
+	}
+
+	if (bReadFailed)
+	{
+		UE_LOG(LogBVHRuntime, Error, TEXT("BVHParser: Failed to read %s after frame %d"), *Filename, NumSourceFrames);
+		return false;
+	}
+
+	FinishWindowedMotion(OutData, Window, NumSourceFrames, NumParsedFrames);
+	return true;
+}
+
+FString FBVHParser::GetNextToken(FString& Line)
+{
+	FString Trimmed = Line.TrimStartAndEnd();
+	int32 SpaceIdx;
+	if (Trimmed.FindChar(' ', SpaceIdx))
+	{
+		return Trimmed.Left(SpaceIdx);
+	}
+	return Trimmed;
+}
+
+bool FBVHParser::ReadLine(FString& OutLine)
+{
+	if (CurrentLineIndex < Lines.Num())
+	{
+		OutLine = Lines[CurrentLineIndex++];
+		return true;
+	}
+	return false;
+}
+
+bool FBVHParser::ParseFrameLine(FAnsiStringView Line, TArrayView<double> OutValues, int32 NumLeadingTokens)
+{
+	FBVHTokenizer Tokenizer(Line);
+	FAnsiStringView Token;
+	for (int32 Skipped = 0; Skipped < NumLeadingTokens; ++Skipped)
+	{
+		if (!Tokenizer.NextTokenOnLine(Token))
+		{
+			return false;
+		}
+	}
+
+	for (double& Value : OutValues)
+	{
+		if (!Tokenizer.NextTokenOnLine(Token) || !FBVHTokenizer::TryToDouble(Token, Value))
+		{
+			return false;
+		}
+	}
+	return true;
+}
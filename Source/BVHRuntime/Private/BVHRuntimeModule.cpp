@@ -0,0 +1,10 @@
+#include "BVHRuntimeLog.h"
+#include "Modules/ModuleManager.h"
+
+DEFINE_LOG_CATEGORY(LogBVHRuntime);
+
+DEFINE_STAT(STAT_BVHFileLoad);
+DEFINE_STAT(STAT_BVHHierarchyParse);
+DEFINE_STAT(STAT_BVHMotionParse);
+
+IMPLEMENT_MODULE(FDefaultModuleImpl, BVHRuntime)
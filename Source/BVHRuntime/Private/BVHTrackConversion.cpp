@@ -0,0 +1,348 @@
+#include "BVHTrackConversion.h"
+#include "Math/VectorRegister.h"
+
+namespace BVHTrackConversion
+{
+	namespace
+	{
+		constexpr int32 BatchSize = 4;
+
+		// Quaternion lanes for BatchSize frames, one register per component
+		struct FQuatBatch
+		{
+			VectorRegister4Double X;
+			VectorRegister4Double Y;
+			VectorRegister4Double Z;
+			VectorRegister4Double W;
+		};
+
+		template <EBVHRotationOrder Order>
+		struct TRotationOrderAxes;
+
+#define BVH_ROTATION_ORDER_AXES(Order, A0, A1, A2) \
+		template <> \
+		struct TRotationOrderAxes<EBVHRotationOrder::Order> \
+		{ \
+			static constexpr EBVHChannel First = EBVHChannel::A0; \
+			static constexpr EBVHChannel Second = EBVHChannel::A1; \
+			static constexpr EBVHChannel Third = EBVHChannel::A2; \
+		};
+
+		BVH_ROTATION_ORDER_AXES(XYZ, Xrotation, Yrotation, Zrotation)
+		BVH_ROTATION_ORDER_AXES(XZY, Xrotation, Zrotation, Yrotation)
+		BVH_ROTATION_ORDER_AXES(YXZ, Yrotation, Xrotation, Zrotation)
+		BVH_ROTATION_ORDER_AXES(YZX, Yrotation, Zrotation, Xrotation)
+		BVH_ROTATION_ORDER_AXES(ZXY, Zrotation, Xrotation, Yrotation)
+		BVH_ROTATION_ORDER_AXES(ZYX, Zrotation, Yrotation, Xrotation)
+
+#undef BVH_ROTATION_ORDER_AXES
+
+		/** Q = Q * (axis * S, C), the product expanded for a single principal axis */
+		template <EBVHChannel Axis>
+		FORCEINLINE void ApplyAxisRotation(FQuatBatch& Q, const VectorRegister4Double& S, const VectorRegister4Double& C)
+		{
+			VectorRegister4Double NX, NY, NZ, NW;
+			if constexpr (Axis == EBVHChannel::Xrotation)
+			{
+				NX = VectorMultiplyAdd(Q.W, S, VectorMultiply(Q.X, C));
+				NY = VectorMultiplyAdd(Q.Z, S, VectorMultiply(Q.Y, C));
+				NZ = VectorNegateMultiplyAdd(Q.Y, S, VectorMultiply(Q.Z, C));
+				NW = VectorNegateMultiplyAdd(Q.X, S, VectorMultiply(Q.W, C));
+			}
+			else if constexpr (Axis == EBVHChannel::Yrotation)
+			{
+				NX = VectorNegateMultiplyAdd(Q.Z, S, VectorMultiply(Q.X, C));
+				NY = VectorMultiplyAdd(Q.W, S, VectorMultiply(Q.Y, C));
+				NZ = VectorMultiplyAdd(Q.X, S, VectorMultiply(Q.Z, C));
+				NW = VectorNegateMultiplyAdd(Q.Y, S, VectorMultiply(Q.W, C));
+			}
+			else
+			{
+				static_assert(Axis == EBVHChannel::Zrotation, "Not a rotation channel");
+				NX = VectorMultiplyAdd(Q.Y, S, VectorMultiply(Q.X, C));
+				NY = VectorNegateMultiplyAdd(Q.X, S, VectorMultiply(Q.Y, C));
+				NZ = VectorMultiplyAdd(Q.W, S, VectorMultiply(Q.Z, C));
+				NW = VectorNegateMultiplyAdd(Q.Z, S, VectorMultiply(Q.W, C));
+			}
+			Q.X = NX;
+			Q.Y = NY;
+			Q.Z = NZ;
+			Q.W = NW;
+		}
+
+		/** Identity * (axis * S, C) */
+		template <EBVHChannel Axis>
+		FORCEINLINE FQuatBatch MakeAxisRotation(const VectorRegister4Double& S, const VectorRegister4Double& C)
+		{
+			const VectorRegister4Double Zero = VectorSetFloat1(0.0);
+			FQuatBatch Q;
+			Q.X = Axis == EBVHChannel::Xrotation ? S : Zero;
+			Q.Y = Axis == EBVHChannel::Yrotation ? S : Zero;
+			Q.Z = Axis == EBVHChannel::Zrotation ? S : Zero;
+			Q.W = C;
+			return Q;
+		}
+
+		FORCEINLINE void ApplyAxisRotation(EBVHChannel Axis, FQuatBatch& Q, const VectorRegister4Double& S, const VectorRegister4Double& C)
+		{
+			switch (Axis)
+			{
+			case EBVHChannel::Xrotation: ApplyAxisRotation<EBVHChannel::Xrotation>(Q, S, C); break;
+			case EBVHChannel::Yrotation: ApplyAxisRotation<EBVHChannel::Yrotation>(Q, S, C); break;
+			case EBVHChannel::Zrotation: ApplyAxisRotation<EBVHChannel::Zrotation>(Q, S, C); break;
+			default: break;
+			}
+		}
+
+		FORCEINLINE VectorRegister4Double LoadHalfAngles(const double* Track, const VectorRegister4Double& HalfDegreesToRadians)
+		{
+			return VectorMultiply(VectorLoad(Track), HalfDegreesToRadians);
+		}
+
+		// Remainder frames run through the same lanes, zero padded
+		FORCEINLINE VectorRegister4Double LoadHalfAnglesPadded(const double* Track, int32 Count, const VectorRegister4Double& HalfDegreesToRadians)
+		{
+			alignas(32) double Padded[BatchSize] = {};
+			FMemory::Memcpy(Padded, Track, Count * sizeof(double));
+			return VectorMultiply(VectorLoadAligned(Padded), HalfDegreesToRadians);
+		}
+
+		FORCEINLINE FQuatBatch ComposeBatch(TConstArrayView<EBVHChannel> RotationAxes, const VectorRegister4Double* HalfAngles)
+		{
+			FQuatBatch Q;
+			Q.X = VectorSetFloat1(0.0);
+			Q.Y = VectorSetFloat1(0.0);
+			Q.Z = VectorSetFloat1(0.0);
+			Q.W = VectorSetFloat1(1.0);
+
+			for (int32 i = 0; i < RotationAxes.Num(); ++i)
+			{
+				VectorRegister4Double S, C;
+				VectorSinCos(&S, &C, &HalfAngles[i]);
+				ApplyAxisRotation(RotationAxes[i], Q, S, C);
+			}
+			return Q;
+		}
+
+		template <EBVHRotationOrder Order>
+		FORCEINLINE FQuatBatch ComposeOrdered(const VectorRegister4Double* HalfAngles)
+		{
+			using FAxes = TRotationOrderAxes<Order>;
+
+			VectorRegister4Double S0, C0, S1, C1, S2, C2;
+			VectorSinCos(&S0, &C0, &HalfAngles[0]);
+			VectorSinCos(&S1, &C1, &HalfAngles[1]);
+			VectorSinCos(&S2, &C2, &HalfAngles[2]);
+
+			FQuatBatch Q = MakeAxisRotation<FAxes::First>(S0, C0);
+			ApplyAxisRotation<FAxes::Second>(Q, S1, C1);
+			ApplyAxisRotation<FAxes::Third>(Q, S2, C2);
+			return Q;
+		}
+
+		FORCEINLINE void StoreBatch(const FQuatBatch& Q, FQuat* OutRotations, int32 Count)
+		{
+			alignas(32) double X[BatchSize], Y[BatchSize], Z[BatchSize], W[BatchSize];
+			VectorStoreAligned(Q.X, X);
+			VectorStoreAligned(Q.Y, Y);
+			VectorStoreAligned(Q.Z, Z);
+			VectorStoreAligned(Q.W, W);
+
+			// ConvertRot folded into the scatter
+			for (int32 Lane = 0; Lane < Count; ++Lane)
+			{
+				OutRotations[Lane] = FQuat(X[Lane], -Z[Lane], Y[Lane], W[Lane]);
+			}
+		}
+
+		template <EBVHRotationOrder Order>
+		void EulerToQuatOrdered(const double* const* Tracks, int32 NumFrames, FQuat* OutRotations)
+		{
+			const VectorRegister4Double HalfDegreesToRadians = VectorSetFloat1(UE_DOUBLE_PI / 360.0);
+			VectorRegister4Double HalfAngles[3];
+
+			int32 Frame = 0;
+			for (; Frame + BatchSize <= NumFrames; Frame += BatchSize)
+			{
+				HalfAngles[0] = LoadHalfAngles(Tracks[0] + Frame, HalfDegreesToRadians);
+				HalfAngles[1] = LoadHalfAngles(Tracks[1] + Frame, HalfDegreesToRadians);
+				HalfAngles[2] = LoadHalfAngles(Tracks[2] + Frame, HalfDegreesToRadians);
+				StoreBatch(ComposeOrdered<Order>(HalfAngles), OutRotations + Frame, BatchSize);
+			}
+
+			const int32 NumRemaining = NumFrames - Frame;
+			if (NumRemaining > 0)
+			{
+				for (int32 i = 0; i < 3; ++i)
+				{
+					HalfAngles[i] = LoadHalfAnglesPadded(Tracks[i] + Frame, NumRemaining, HalfDegreesToRadians);
+				}
+				StoreBatch(ComposeOrdered<Order>(HalfAngles), OutRotations + Frame, NumRemaining);
+			}
+		}
+	}
+
+	void EulerToQuatBatch(TConstArrayView<EBVHChannel> RotationAxes, TConstArrayView<const double*> AngleTracks, int32 NumFrames, FQuat* OutRotations)
+	{
+		check(RotationAxes.Num() == AngleTracks.Num() && RotationAxes.Num() <= 3);
+
+		if (RotationAxes.Num() == 0)
+		{
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				OutRotations[Frame] = FQuat::Identity;
+			}
+			return;
+		}
+
+		const VectorRegister4Double HalfDegreesToRadians = VectorSetFloat1(UE_DOUBLE_PI / 360.0);
+		VectorRegister4Double HalfAngles[3];
+
+		int32 Frame = 0;
+		for (; Frame + BatchSize <= NumFrames; Frame += BatchSize)
+		{
+			for (int32 i = 0; i < AngleTracks.Num(); ++i)
+			{
+				HalfAngles[i] = LoadHalfAngles(AngleTracks[i] + Frame, HalfDegreesToRadians);
+			}
+			StoreBatch(ComposeBatch(RotationAxes, HalfAngles), OutRotations + Frame, BatchSize);
+		}
+
+		const int32 NumRemaining = NumFrames - Frame;
+		if (NumRemaining > 0)
+		{
+			for (int32 i = 0; i < AngleTracks.Num(); ++i)
+			{
+				HalfAngles[i] = LoadHalfAnglesPadded(AngleTracks[i] + Frame, NumRemaining, HalfDegreesToRadians);
+			}
+			StoreBatch(ComposeBatch(RotationAxes, HalfAngles), OutRotations + Frame, NumRemaining);
+		}
+	}
+
+	void EulerToQuatScalar(TConstArrayView<EBVHChannel> RotationAxes, TConstArrayView<const double*> AngleTracks, int32 NumFrames, FQuat* OutRotations)
+	{
+		check(RotationAxes.Num() == AngleTracks.Num());
+
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			FQuat LocalRot = FQuat::Identity;
+			for (int32 i = 0; i < RotationAxes.Num(); ++i)
+			{
+				const double Val = AngleTracks[i][Frame];
+				FQuat ChanRot = FQuat::Identity;
+
+				if (RotationAxes[i] == EBVHChannel::Xrotation)
+					ChanRot = FQuat(FVector(1, 0, 0), FMath::DegreesToRadians(Val));
+				else if (RotationAxes[i] == EBVHChannel::Yrotation)
+					ChanRot = FQuat(FVector(0, 1, 0), FMath::DegreesToRadians(Val));
+				else if (RotationAxes[i] == EBVHChannel::Zrotation)
+					ChanRot = FQuat(FVector(0, 0, 1), FMath::DegreesToRadians(Val));
+
+				if (!ChanRot.IsIdentity())
+				{
+					LocalRot = LocalRot * ChanRot;
+				}
+			}
+			OutRotations[Frame] = ConvertRot(LocalRot);
+		}
+	}
+
+	void SamplePositions(const FBVHNode& Node, TConstArrayView<const double*> NodeTracks, int32 NumFrames, FVector* OutPositions)
+	{
+		// Without position channels the bone stays at its rest offset
+		if (Node.PositionMask == 0)
+		{
+			const FVector RestPosition = ConvertPos(Node.Offset);
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				OutPositions[Frame] = RestPosition;
+			}
+			return;
+		}
+
+		// Position channels replace the offset, missing axes stay zero
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			OutPositions[Frame] = FVector::ZeroVector;
+		}
+
+		// One pass per present axis, writing the ConvertPos mapping directly
+		if (Node.PositionChannels[0] != INDEX_NONE)
+		{
+			const double* Track = NodeTracks[Node.PositionChannels[0]];
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				OutPositions[Frame].X = Track[Frame];
+			}
+		}
+		if (Node.PositionChannels[1] != INDEX_NONE)
+		{
+			const double* Track = NodeTracks[Node.PositionChannels[1]];
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				OutPositions[Frame].Z = Track[Frame];
+			}
+		}
+		if (Node.PositionChannels[2] != INDEX_NONE)
+		{
+			const double* Track = NodeTracks[Node.PositionChannels[2]];
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				OutPositions[Frame].Y = -Track[Frame];
+			}
+		}
+	}
+
+	void SampleRotations(const FBVHNode& Node, TConstArrayView<const double*> NodeTracks, int32 NumFrames, FQuat* OutRotations)
+	{
+		const double* Tracks[3] = {};
+		if (Node.RotationOrder != EBVHRotationOrder::None && Node.RotationOrder != EBVHRotationOrder::Custom)
+		{
+			for (int32 i = 0; i < 3; ++i)
+			{
+				Tracks[i] = NodeTracks[Node.RotationChannels[i]];
+			}
+		}
+
+		switch (Node.RotationOrder)
+		{
+		case EBVHRotationOrder::XYZ: EulerToQuatOrdered<EBVHRotationOrder::XYZ>(Tracks, NumFrames, OutRotations); break;
+		case EBVHRotationOrder::XZY: EulerToQuatOrdered<EBVHRotationOrder::XZY>(Tracks, NumFrames, OutRotations); break;
+		case EBVHRotationOrder::YXZ: EulerToQuatOrdered<EBVHRotationOrder::YXZ>(Tracks, NumFrames, OutRotations); break;
+		case EBVHRotationOrder::YZX: EulerToQuatOrdered<EBVHRotationOrder::YZX>(Tracks, NumFrames, OutRotations); break;
+		case EBVHRotationOrder::ZXY: EulerToQuatOrdered<EBVHRotationOrder::ZXY>(Tracks, NumFrames, OutRotations); break;
+		case EBVHRotationOrder::ZYX: EulerToQuatOrdered<EBVHRotationOrder::ZYX>(Tracks, NumFrames, OutRotations); break;
+		case EBVHRotationOrder::None:
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				OutRotations[Frame] = FQuat::Identity;
+			}
+			break;
+		case EBVHRotationOrder::Custom:
+		default:
+		{
+			TArray<EBVHChannel, TInlineAllocator<3>> RotationAxes;
+			TArray<const double*, TInlineAllocator<3>> RotationTracks;
+			for (int32 i = 0; i < Node.Channels.Num(); ++i)
+			{
+				const EBVHChannel Chan = Node.Channels[i];
+				if (Chan == EBVHChannel::Xrotation || Chan == EBVHChannel::Yrotation || Chan == EBVHChannel::Zrotation)
+				{
+					RotationAxes.Add(Chan);
+					RotationTracks.Add(NodeTracks[i]);
+				}
+			}
+
+			if (RotationAxes.Num() <= 3)
+			{
+				EulerToQuatBatch(RotationAxes, RotationTracks, NumFrames, OutRotations);
+			}
+			else
+			{
+				EulerToQuatScalar(RotationAxes, RotationTracks, NumFrames, OutRotations);
+			}
+			break;
+		}
+		}
+	}
+}
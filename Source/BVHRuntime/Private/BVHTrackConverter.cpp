@@ -0,0 +1,71 @@
+#include "BVHTrackConverter.h"
+#include "BVHTrackConversion.h"
+
+void FBVHTrackConverter::Initialize(const FBVHData& Data)
+{
+	Nodes = Data.Nodes;
+	NumChannels = Data.NumChannels;
+}
+
+void FBVHTrackConverter::InitPose(FBVHPoseBuffer& OutPose) const
+{
+	OutPose.LocalTransforms.SetNum(Nodes.Num());
+	OutPose.ChannelValues.SetNumZeroed(NumChannels);
+}
+
+void FBVHTrackConverter::EvaluatePose(TConstArrayView<double> FrameValues, FBVHPoseBuffer& Pose) const
+{
+	check(FrameValues.Num() == NumChannels);
+	EvaluateChannels(FrameValues.GetData(), 1, Pose);
+}
+
+void FBVHTrackConverter::EvaluatePose(const FBVHData& Data, int32 FrameIndex, FBVHPoseBuffer& Pose) const
+{
+	check(Data.NumChannels == NumChannels && FrameIndex >= 0 && FrameIndex < Data.NumFrames);
+	if (Data.Layout == EBVHMotionLayout::FrameMajor)
+	{
+		EvaluateChannels(Data.MotionData.GetData() + (int64)FrameIndex * NumChannels, 1, Pose);
+	}
+	else
+	{
+		EvaluateChannels(Data.MotionData.GetData() + FrameIndex, Data.NumFrames, Pose);
+	}
+}
+
+void FBVHTrackConverter::EvaluateChannels(const double* FirstValue, int64 ChannelStride, FBVHPoseBuffer& Pose) const
+{
+	check(Pose.LocalTransforms.Num() == Nodes.Num() && Pose.ChannelValues.Num() == NumChannels);
+
+	// A single frame is a one-key track per channel, so the batched samplers apply unchanged
+	for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+	{
+		Pose.ChannelValues[Channel] = FirstValue + Channel * ChannelStride;
+	}
+
+	for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+	{
+		const FBVHNode& Node = Nodes[NodeIndex];
+		const TConstArrayView<const double*> NodeTracks = Node.Channels.Num() > 0
+			? TConstArrayView<const double*>(Pose.ChannelValues.GetData() + Node.ChannelStartIndex, Node.Channels.Num())
+			: TConstArrayView<const double*>();
+
+		FVector Position;
+		FQuat Rotation;
+		BVHTrackConversion::SamplePositions(Node, NodeTracks, 1, &Position);
+		BVHTrackConversion::SampleRotations(Node, NodeTracks, 1, &Rotation);
+		Pose.LocalTransforms[NodeIndex] = FTransform(Rotation, Position);
+	}
+}
+
+void FBVHTrackConverter::ConvertNodeChunk(const FBVHNode& Node, const FBVHMotionChunk& Chunk, FVector* OutPositions, FQuat* OutRotations)
+{
+	// The channel layout was resolved at parse time, so both samplers run without per-frame channel branches
+	TArray<const double*, TInlineAllocator<6>> NodeTracks;
+	for (int32 i = 0; i < Node.Channels.Num(); ++i)
+	{
+		NodeTracks.Add(Chunk.GetChannel(Node.ChannelStartIndex + i).GetData());
+	}
+
+	BVHTrackConversion::SamplePositions(Node, NodeTracks, Chunk.NumFrames, OutPositions);
+	BVHTrackConversion::SampleRotations(Node, NodeTracks, Chunk.NumFrames, OutRotations);
+}
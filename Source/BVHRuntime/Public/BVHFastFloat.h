@@ -0,0 +1,115 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Decimal to double conversion for BVH motion tokens.
+ * Handles the Clinger fast path: when the decimal significand fits in 53 bits and the power of ten is exactly
+ * representable (|exponent| <= 22), one IEEE multiply or divide gives the correctly rounded result, which is
+ * bit-identical to FCStringAnsi::Atod. Tokens outside that range or outside the plain decimal grammar are
+ * reported as unhandled so the caller can fall back to Atod.
+ */
+namespace BVHFastFloat
+{
+	inline bool TryParse(const ANSICHAR* Cursor, const ANSICHAR* End, double& OutValue)
+	{
+		static constexpr double PowersOfTen[] =
+		{
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+		constexpr int32 MaxExactPower = UE_ARRAY_COUNT(PowersOfTen) - 1;
+		constexpr uint64 MaxExactMantissa = uint64(1) << 53;
+
+		const auto IsDigit = [](ANSICHAR C) { return C >= '0' && C <= '9'; };
+
+		bool bNegative = false;
+		if (Cursor < End && (*Cursor == '-' || *Cursor == '+'))
+		{
+			bNegative = *Cursor == '-';
+			++Cursor;
+		}
+
+		// Digits past what a uint64 holds can still round differently, those go to the fallback
+		uint64 Mantissa = 0;
+		int32 Exponent = 0;
+		bool bAnyDigit = false;
+		for (; Cursor < End && IsDigit(*Cursor); ++Cursor)
+		{
+			if (Mantissa > (MAX_uint64 - 9) / 10)
+			{
+				return false;
+			}
+			Mantissa = Mantissa * 10 + (*Cursor - '0');
+			bAnyDigit = true;
+		}
+
+		if (Cursor < End && *Cursor == '.')
+		{
+			for (++Cursor; Cursor < End && IsDigit(*Cursor); ++Cursor)
+			{
+				if (Mantissa > (MAX_uint64 - 9) / 10)
+				{
+					return false;
+				}
+				Mantissa = Mantissa * 10 + (*Cursor - '0');
+				--Exponent;
+				bAnyDigit = true;
+			}
+		}
+
+		if (!bAnyDigit)
+		{
+			return false;
+		}
+
+		if (Cursor < End && (*Cursor == 'e' || *Cursor == 'E'))
+		{
+			++Cursor;
+			bool bNegativeExponent = false;
+			if (Cursor < End && (*Cursor == '-' || *Cursor == '+'))
+			{
+				bNegativeExponent = *Cursor == '-';
+				++Cursor;
+			}
+
+			if (Cursor >= End || !IsDigit(*Cursor))
+			{
+				return false;
+			}
+
+			int32 ExplicitExponent = 0;
+			for (; Cursor < End && IsDigit(*Cursor); ++Cursor)
+			{
+				if (ExplicitExponent < 100000)
+				{
+					ExplicitExponent = ExplicitExponent * 10 + (*Cursor - '0');
+				}
+			}
+			Exponent += bNegativeExponent ? -ExplicitExponent : ExplicitExponent;
+		}
+
+		// Trailing characters follow Atod's prefix rules, which the fallback handles
+		if (Cursor != End)
+		{
+			return false;
+		}
+
+		if (Mantissa == 0)
+		{
+			OutValue = bNegative ? -0.0 : 0.0;
+			return true;
+		}
+
+		if (Mantissa > MaxExactMantissa || Exponent < -MaxExactPower || Exponent > MaxExactPower)
+		{
+			return false;
+		}
+
+		// Both operands are exact, so the single rounding step is the correctly rounded result
+		double Value = (double)Mantissa;
+		Value = Exponent < 0 ? Value / PowersOfTen[-Exponent] : Value * PowersOfTen[Exponent];
+		OutValue = bNegative ? -Value : Value;
+		return true;
+	}
+}
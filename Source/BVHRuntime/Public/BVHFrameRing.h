@@ -0,0 +1,107 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+ * Single-producer single-consumer ring of fixed-size frames, lock-free on both ends.
+ * The producer writes a slot in place between BeginWrite and EndWrite and drops the frame when the
+ * consumer has fallen a full ring behind, so neither side ever waits on the other. Storage is
+ * allocated once by Initialize.
+ */
+class FBVHFrameRing
+{
+public:
+	/** Sizes the ring, Capacity is rounded up to a power of two. Not thread-safe, call before either side runs */
+	void Initialize(int32 InNumChannels, int32 Capacity)
+	{
+		NumChannels = InNumChannels;
+		const uint32 NumSlots = FMath::RoundUpToPowerOfTwo((uint32)FMath::Max(Capacity, 2));
+		Mask = NumSlots - 1;
+		Values.SetNumZeroed((int64)NumSlots * NumChannels);
+		Timestamps.SetNumZeroed(NumSlots);
+		WriteIndex.store(0, std::memory_order_relaxed);
+		ReadIndex.store(0, std::memory_order_relaxed);
+		NumDropped.store(0, std::memory_order_relaxed);
+	}
+
+	int32 GetNumChannels() const { return NumChannels; }
+
+	/** Frames written but not popped yet, approximate while the other side runs */
+	int32 Num() const
+	{
+		return (int32)(WriteIndex.load(std::memory_order_acquire) - ReadIndex.load(std::memory_order_acquire));
+	}
+
+	/** Frames the producer dropped because the ring was full */
+	int32 GetNumDropped() const { return NumDropped.load(std::memory_order_relaxed); }
+
+	// Producer side
+
+	/** Slot for the next frame, NumChannels values, or nullptr when the ring is full */
+	double* BeginWrite()
+	{
+		const uint32 Write = WriteIndex.load(std::memory_order_relaxed);
+		if (Write - ReadIndex.load(std::memory_order_acquire) > Mask)
+		{
+			NumDropped.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		return Values.GetData() + (int64)(Write & Mask) * NumChannels;
+	}
+
+	/** Publishes the slot returned by the last BeginWrite */
+	void EndWrite(double Timestamp)
+	{
+		const uint32 Write = WriteIndex.load(std::memory_order_relaxed);
+		Timestamps[Write & Mask] = Timestamp;
+		WriteIndex.store(Write + 1, std::memory_order_release);
+	}
+
+	// Consumer side
+
+	/** Copies out the oldest frame, returns false when the ring is empty */
+	bool Pop(TArrayView<double> OutValues, double& OutTimestamp)
+	{
+		const uint32 Read = ReadIndex.load(std::memory_order_relaxed);
+		if (Read == WriteIndex.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		CopySlot(Read, OutValues, OutTimestamp);
+		ReadIndex.store(Read + 1, std::memory_order_release);
+		return true;
+	}
+
+	/** Copies out the newest frame and discards every older one, returns false when the ring is empty */
+	bool PopLatest(TArrayView<double> OutValues, double& OutTimestamp)
+	{
+		const uint32 Write = WriteIndex.load(std::memory_order_acquire);
+		if (ReadIndex.load(std::memory_order_relaxed) == Write)
+		{
+			return false;
+		}
+		// The producer cannot reach this slot again until the read index moves past it
+		CopySlot(Write - 1, OutValues, OutTimestamp);
+		ReadIndex.store(Write, std::memory_order_release);
+		return true;
+	}
+
+private:
+	void CopySlot(uint32 Index, TArrayView<double> OutValues, double& OutTimestamp) const
+	{
+		check(OutValues.Num() == NumChannels);
+		FMemory::Memcpy(OutValues.GetData(), Values.GetData() + (int64)(Index & Mask) * NumChannels, NumChannels * sizeof(double));
+		OutTimestamp = Timestamps[Index & Mask];
+	}
+
+	TArray64<double> Values; // [Slot * NumChannels + ChannelIndex]
+	TArray<double> Timestamps;
+	int32 NumChannels = 0;
+	uint32 Mask = 0;
+
+	// Each index is written by one side only, kept on separate cache lines so the sides do not share one
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> WriteIndex{0};
+	std::atomic<int32> NumDropped{0};
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> ReadIndex{0};
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/AssetUserData.h"
+#include "Misc/FrameRate.h"
+#include "BVHImportUserData.generated.h"
+
+/**
+ * Attached to imported animation sequences. Records what the last import wrote so a reimport can
+ * convert and rewrite only the bone tracks whose source changed. Editor-only, nothing of it is cooked.
+ */
+UCLASS()
+class BVHRUNTIME_API UBVHImportUserData : public UAssetUserData
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool IsEditorOnly() const override { return true; }
+
+#if WITH_EDITORONLY_DATA
+	// Joint names and tree shape of the source file
+	UPROPERTY()
+	uint32 HierarchyHash = 0;
+
+	UPROPERTY()
+	FFrameRate FrameRate;
+
+	UPROPERTY()
+	int32 NumKeys = 0;
+
+	// Hash of each bone's source channels, offset and rotation order, seeded with the conversion settings
+	UPROPERTY()
+	TMap<FName, uint64> SourceHashes;
+
+	// Options the import ran with, reapplied on reimport so the edited file converts the same way
+	UPROPERTY()
+	FFrameRate TargetFrameRate = FFrameRate(0, 0);
+
+	UPROPERTY()
+	bool bKeepSourceFrameRate = false;
+
+	UPROPERTY()
+	bool bReduceConstantTracks = false;
+
+	UPROPERTY()
+	double ConstantPositionTolerance = 0.001;
+
+	UPROPERTY()
+	double ConstantRotationTolerance = 0.01;
+
+	// Frame window, INDEX_NONE frames for the rest of the take
+	UPROPERTY()
+	int32 FirstFrame = 0;
+
+	UPROPERTY()
+	int32 NumFrames = INDEX_NONE;
+
+	UPROPERTY()
+	int32 FrameStride = 1;
+
+	// Joint filter wildcards
+	UPROPERTY()
+	TArray<FString> IncludeBones;
+
+	UPROPERTY()
+	TArray<FString> ExcludeBones;
+
+	UPROPERTY()
+	bool bExcludeEndSites = false;
+#endif
+};
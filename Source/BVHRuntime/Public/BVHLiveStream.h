@@ -0,0 +1,77 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BVHFrameRing.h"
+#include "HAL/Runnable.h"
+#include <atomic>
+
+class FRunnableThread;
+class FSocket;
+
+enum class EBVHLiveProtocol : uint8
+{
+	// Connects to Host:Port and reads a continuous line stream, reconnecting when the server drops
+	Tcp,
+	// Binds Port on all interfaces, each datagram holds one or more frame lines
+	Udp
+};
+
+struct FBVHLiveStreamSettings
+{
+	EBVHLiveProtocol Protocol = EBVHLiveProtocol::Tcp;
+	FString Host = TEXT("127.0.0.1"); // Server IP address, TCP only
+	int32 Port = 7001;
+
+	// Tokens skipped at the start of every line, e.g. 2 for Axis Neuron's "<Index> <Avatar>" prefix
+	int32 NumLeadingTokens = 0;
+
+	// Frames buffered between the worker and the consumer
+	int32 RingCapacity = 64;
+
+	float ReconnectSeconds = 1.0f;
+};
+
+/**
+ * Receives BVH frame lines from a socket on a worker thread. The hierarchy is known up front, only
+ * its channel count matters here: every complete line is parsed straight into the next slot of a
+ * lock-free ring that the game thread drains without blocking. Lines that are not frames, such as a
+ * HIERARCHY header some servers send on connect, are counted and skipped.
+ */
+class BVHRUNTIME_API FBVHLiveStream : public FRunnable
+{
+public:
+	FBVHLiveStream(int32 NumChannels, const FBVHLiveStreamSettings& InSettings);
+	virtual ~FBVHLiveStream();
+
+	/** Starts the worker thread, returns false when it could not be created */
+	bool Start();
+
+	/** Stops the worker and waits for it to exit */
+	void Shutdown();
+
+	bool IsConnected() const { return bConnected.load(std::memory_order_relaxed); }
+	int32 GetNumMalformedLines() const { return NumMalformedLines.load(std::memory_order_relaxed); }
+
+	/** Consumer end of the ring, to be drained from a single thread */
+	FBVHFrameRing& GetFrames() { return Frames; }
+
+	// FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	FSocket* OpenSocket() const;
+	void ConsumeBytes(const uint8* Data, int32 NumBytes);
+	void ParseLine(FAnsiStringView Line);
+
+	FBVHLiveStreamSettings Settings;
+	FBVHFrameRing Frames;
+
+	// Worker only: the unterminated tail of the last receive
+	TArray<ANSICHAR> PendingLine;
+
+	FRunnableThread* Thread = nullptr;
+	std::atomic<bool> bStopRequested{false};
+	std::atomic<bool> bConnected{false};
+	std::atomic<int32> NumMalformedLines{0};
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BVHLiveStream.h"
+#include "BVHParser.h"
+#include "BVHTrackConverter.h"
+#include "Components/ActorComponent.h"
+#include "Engine/EngineTypes.h"
+#include "BVHLiveStreamComponent.generated.h"
+
+/**
+ * Drives a pose from a live BVH broadcast. A worker thread fills the stream's frame ring; each tick
+ * the component takes the newest frame, or every frame while recording, and evaluates it into a
+ * preallocated pose buffer. Ticking never waits on the network and never allocates outside recording.
+ * Anim instances and nodes read the result through GetLocalPose.
+ *
+ * The pose is double-buffered: the tick evaluates into the back buffer and then swaps it to the front.
+ * A view returned by GetLocalPose keeps its values until the second tick after it was taken, so an
+ * animation evaluated on a worker thread during the frame never sees a half-written pose. Readers must
+ * tick after this component to see the newest frame; skeletal meshes on the owner are made to at
+ * BeginPlay, anything else calls AddPoseReader.
+ */
+UCLASS(ClassGroup = (Animation), meta = (BlueprintSpawnableComponent))
+class BVHRUNTIME_API UBVHLiveStreamComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UBVHLiveStreamComponent();
+
+	// BVH file with the hierarchy the server streams, its motion is ignored
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "BVH Live", meta = (FilePathFilter = "bvh"))
+	FFilePath HierarchyFile;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "BVH Live")
+	bool bUseUdp = false;
+
+	// Server IP address, unused for UDP
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "BVH Live")
+	FString Host = TEXT("127.0.0.1");
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "BVH Live", meta = (ClampMin = "1", ClampMax = "65535"))
+	int32 Port = 7001;
+
+	// Tokens skipped at the start of every frame line, e.g. 2 for Axis Neuron's "<Index> <Avatar>" prefix
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "BVH Live", meta = (ClampMin = "0"))
+	int32 NumLeadingTokens = 0;
+
+	// Frames buffered between the network thread and the game thread
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "BVH Live", meta = (ClampMin = "2"))
+	int32 RingCapacity = 64;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "BVH Live")
+	bool bConnectOnBeginPlay = true;
+
+	/** Loads the hierarchy and starts receiving, restarting the stream when already connected */
+	UFUNCTION(BlueprintCallable, Category = "BVH Live")
+	bool Connect();
+
+	/** Uses a hierarchy parsed elsewhere instead of HierarchyFile */
+	bool ConnectWithHierarchy(const FBVHData& Hierarchy);
+
+	UFUNCTION(BlueprintCallable, Category = "BVH Live")
+	void Disconnect();
+
+	UFUNCTION(BlueprintPure, Category = "BVH Live")
+	bool IsConnected() const;
+
+	/** Starts collecting every received frame, at the cost of appending to the recording each tick */
+	UFUNCTION(BlueprintCallable, Category = "BVH Live")
+	void StartRecording();
+
+	UFUNCTION(BlueprintCallable, Category = "BVH Live")
+	void StopRecording();
+
+	/** Frames received while recording, FrameMajor, with FrameTime averaged over the arrival times */
+	const FBVHData& GetRecording() const { return Recording; }
+
+	/** Makes Reader tick after this component, so it reads the pose of the current frame */
+	UFUNCTION(BlueprintCallable, Category = "BVH Live")
+	void AddPoseReader(UActorComponent* Reader);
+
+	/** UE-space local transform per hierarchy node, as of the newest frame received. Front buffer, see the class comment. */
+	TConstArrayView<FTransform> GetLocalPose() const { return Poses[FrontPose].LocalTransforms; }
+
+	/** The hierarchy GetLocalPose is indexed by */
+	TConstArrayView<FBVHNode> GetNodes() const { return Converter.GetNodes(); }
+
+	/** Arrival time of the frame behind GetLocalPose, in FPlatformTime::Seconds, or 0 before the first */
+	double GetPoseTimestamp() const { return PoseTimestamp; }
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+	TUniquePtr<FBVHLiveStream> Stream;
+	FBVHTrackConverter Converter;
+	FBVHPoseBuffer Poses[2];
+	int32 FrontPose = 0;
+	TArray<double> FrameValues;
+	double PoseTimestamp = 0.0;
+
+	bool bRecording = false;
+	FBVHData Recording;
+	double RecordingStartTime = 0.0;
+	double RecordingLastTime = 0.0;
+};
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EBVHChannel : uint8
+{
+	Xposition,
+	Yposition,
+	Zposition,
+	Zrotation,
+	Xrotation,
+	Yrotation,
+	Unknown
+};
+
+// Order the rotation channels appear in, e.g. ZXY composes Rz * Rx * Ry
+enum class EBVHRotationOrder : uint8
+{
+	XYZ,
+	XZY,
+	YXZ,
+	YZX,
+	ZXY,
+	ZYX,
+	None,  // No rotation channels
+	Custom // Partial or repeated rotation channels, composed channel by channel
+};
+
+// One joint or end site of the flattened hierarchy
+struct FBVHNode
+{
+	FName Name;
+	FVector3d Offset;
+	TArray<EBVHChannel> Channels;
+	int32 ParentIndex = INDEX_NONE; // Index into FBVHData::Nodes, always lower than the node's own
+	int32 NumChildren = 0;
+	int32 ChannelStartIndex = -1; // Start index in motion data frame
+
+	// Channel layout, resolved once when the CHANNELS line is parsed
+	EBVHRotationOrder RotationOrder = EBVHRotationOrder::None;
+	uint8 PositionMask = 0; // Bit N set when the node has a position channel for axis N (X, Y, Z)
+	int8 PositionChannels[3] = { INDEX_NONE, INDEX_NONE, INDEX_NONE }; // Node channel index per position axis
+	int8 RotationChannels[3] = { INDEX_NONE, INDEX_NONE, INDEX_NONE }; // Node channel index per rotation, in order
+
+	FBVHNode() : Offset(FVector3d::ZeroVector) {}
+};
+
+enum class EBVHMotionLayout : uint8
+{
+	// [FrameIndex * NumChannels + ChannelIndex], one contiguous row per frame
+	FrameMajor,
+	// [ChannelIndex * NumFrames + FrameIndex], one contiguous track per channel
+	ChannelMajor
+};
+
+struct BVHRUNTIME_API FBVHData
+{
+	TArray<FBVHNode> Nodes; // Depth-first, parents before their children, Nodes[0] is the root
+	int32 NumFrames = 0;
+	int32 NumChannels = 0; // Sum of channels over the hierarchy
+	double FrameTime = 0.0;
+	EBVHMotionLayout Layout = EBVHMotionLayout::FrameMajor;
+	TArray<double> MotionData; // Indexed according to Layout
+
+	/** Strided view of a single frame's channel values, FrameMajor only */
+	TConstArrayView<double> GetFrame(int32 FrameIndex) const
+	{
+		check(Layout == EBVHMotionLayout::FrameMajor);
+		return TConstArrayView<double>(MotionData.GetData() + (int64)FrameIndex * NumChannels, NumChannels);
+	}
+
+	/** Contiguous view of one channel over all frames, ChannelMajor only */
+	TConstArrayView<double> GetChannel(int32 ChannelIndex) const
+	{
+		check(Layout == EBVHMotionLayout::ChannelMajor);
+		return TConstArrayView<double>(MotionData.GetData() + (int64)ChannelIndex * NumFrames, NumFrames);
+	}
+
+	double GetValue(int32 FrameIndex, int32 ChannelIndex) const
+	{
+		return Layout == EBVHMotionLayout::FrameMajor
+			? MotionData[(int64)FrameIndex * NumChannels + ChannelIndex]
+			: MotionData[(int64)ChannelIndex * NumFrames + FrameIndex];
+	}
+
+	/** Reorders MotionData in place with a cache-blocked transpose */
+	void ConvertToLayout(EBVHMotionLayout NewLayout);
+};
+
+enum class EBVHParseMode : uint8
+{
+	// Single pass over the raw file bytes, no per-line or per-token strings
+	Tokenized,
+	// Original line based parser, kept as a reference implementation
+	Legacy
+};
+
+struct FBVHParseOptions
+{
+	EBVHParseMode Mode = EBVHParseMode::Tokenized;
+	EBVHMotionLayout Layout = EBVHMotionLayout::FrameMajor;
+
+	// Tokenized mode maps the file instead of loading a copy, falling back to a load when mapping fails
+	bool bMemoryMapped = true;
+
+	// Tokenized mode splits large MOTION blocks on line breaks and parses the pieces concurrently
+	bool bParallelMotion = true;
+
+	// ParseStreaming only: frames handed out per chunk and bytes read from disk per block
+	int32 ChunkFrames = 1024;
+	int32 ReadBlockSize = 1 << 20;
+
+	// Frame window: NumFrames source frames from FirstFrame on, of which every FrameStride-th is kept.
+	// Lines outside the window are skipped without being tokenized, and FrameTime grows by the stride.
+	// A negative NumFrames reads to the end of the take.
+	int32 FirstFrame = 0;
+	int32 NumFrames = INDEX_NONE;
+	int32 FrameStride = 1;
+
+	bool HasFrameWindow() const { return FirstFrame > 0 || NumFrames >= 0 || FrameStride > 1; }
+};
+
+/** A run of consecutive frames delivered by FBVHParser::ParseStreaming */
+struct FBVHMotionChunk
+{
+	int32 FirstFrame = 0;
+	int32 NumFrames = 0;
+	int32 NumChannels = 0;
+	TConstArrayView<double> Values; // [ChannelIndex * ChannelStride + FrameIndex], like a ChannelMajor FBVHData
+
+	/** Values between the starts of consecutive channels. Zero when they are packed NumFrames apart; a frame range of a whole take's motion uses the take's frame count. */
+	int32 ChannelStride = 0;
+
+	/** Contiguous view of one channel over the chunk's frames */
+	TConstArrayView<double> GetChannel(int32 ChannelIndex) const
+	{
+		const int64 Stride = ChannelStride > 0 ? ChannelStride : NumFrames;
+		return TConstArrayView<double>(Values.GetData() + ChannelIndex * Stride, NumFrames);
+	}
+};
+
+class FBVHTokenizer;
+
+class BVHRUNTIME_API FBVHParser
+{
+public:
+	FBVHParser(const FString& InFilename, const FBVHParseOptions& InOptions = FBVHParseOptions());
+	bool Parse(FBVHData& OutData);
+
+	/**
+	 * Parses the hierarchy and hands it to OnHeader, then reads MOTION from disk block by block and
+	 * delivers the frames to OnChunk in chunks of Options.ChunkFrames. OutData.MotionData stays empty,
+	 * so memory is bounded by the chunk and block sizes instead of the file size. OnChunk returns false
+	 * to stop early, which makes ParseStreaming return false.
+	 */
+	bool ParseStreaming(FBVHData& OutData, TFunctionRef<void(const FBVHData&)> OnHeader, TFunctionRef<bool(const FBVHMotionChunk&)> OnChunk);
+
+	/**
+	 * Parses one MOTION frame line, such as a line received from a live stream, into OutValues.
+	 * NumLeadingTokens tokens are skipped first, for the frame counters and actor names some broadcasters
+	 * prepend. Values past OutValues.Num() are ignored. Returns false, without logging, for short lines and on the
+	 * first value token that is not a number, so a corrupt packet is dropped instead of read as zeros.
+	 */
+	static bool ParseFrameLine(FAnsiStringView Line, TArrayView<double> OutValues, int32 NumLeadingTokens = 0);
+
+private:
+	struct FFrameWindow;
+
+	FString Filename;
+	FBVHParseOptions Options;
+	TArray<FString> Lines;
+	int32 CurrentLineIndex;
+
+	bool ParseLines(FBVHData& OutData);
+	bool ParseTokenized(FBVHData& OutData);
+	bool ParseHeaderTokens(FBVHTokenizer& Tokenizer, FBVHData& OutData);
+	bool ParseMotionHeaderTokens(FBVHTokenizer& Tokenizer, FBVHData& OutData);
+	bool ParseHierarchyTokens(FBVHTokenizer& Tokenizer, TArray<FBVHNode>& Nodes);
+	bool ParseMotionTokens(FBVHTokenizer& Tokenizer, FBVHData& OutData);
+
+	bool ParseHierarchy(TArray<FBVHNode>& OutNodes);
+	bool ParseNode(TArray<FBVHNode>& Nodes, int32 ParentIndex);
+	bool ParseMotion(FBVHData& OutData);
+	void FinishMotion(FBVHData& OutData, int32 NumParsedFrames) const;
+	void FinishWindowedMotion(FBVHData& OutData, const FFrameWindow& Window, int32 NumSourceFrames, int32 NumKeptFrames) const;
+	bool ParseMotionTokensChannelMajor(FBVHTokenizer& Tokenizer, FBVHData& OutData);
+	bool ParseMotionTokensParallel(FBVHTokenizer& Tokenizer, FBVHData& OutData);
+	bool ParseMotionTokensWindowed(FBVHTokenizer& Tokenizer, FBVHData& OutData);
+	static int32 AssignChannelIndices(TArray<FBVHNode>& Nodes);
+	static void ResolveChannelLayout(FBVHNode& Node);
+	static int32 AddNode(TArray<FBVHNode>& Nodes, FName Name, int32 ParentIndex);
+	
+	FString GetNextToken(FString& Line);
+	bool ReadLine(FString& OutLine);
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Stats/Stats.h"
+
+BVHRUNTIME_API DECLARE_LOG_CATEGORY_EXTERN(LogBVHRuntime, Log, All);
+
+/**
+ * Import stages, visible through "stat BVHImporter" and as named CPU events in Unreal Insights.
+ * The parse stages live here so the runtime parser reports under the same group as the editor
+ * import. File load covers mapping, block reads and binary cache reads.
+ */
+DECLARE_STATS_GROUP(TEXT("BVHImporter"), STATGROUP_BVHImporter, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("File Load"), STAT_BVHFileLoad, STATGROUP_BVHImporter, BVHRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Hierarchy Parse"), STAT_BVHHierarchyParse, STATGROUP_BVHImporter, BVHRUNTIME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Motion Parse"), STAT_BVHMotionParse, STATGROUP_BVHImporter, BVHRUNTIME_API);
+
+/** Times the enclosing scope as a stage stat and emits an Insights event of the same name */
+#define BVH_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE(Stat)
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BVHFastFloat.h"
+#include "Containers/StringView.h"
+#include <cstring>
+
+/**
+ * Cursor-based tokenizer over a raw ANSI byte range.
+ * Tokens and lines are handed out as views into the source buffer, so nothing is copied into FStrings.
+ */
+class FBVHTokenizer
+{
+public:
+	FBVHTokenizer(const ANSICHAR* InBegin, const ANSICHAR* InEnd)
+		: Cursor(InBegin)
+		, End(InEnd)
+	{
+	}
+
+	explicit FBVHTokenizer(FAnsiStringView InRange)
+		: Cursor(InRange.GetData())
+		, End(InRange.GetData() + InRange.Len())
+	{
+	}
+
+	bool IsAtEnd() const { return Cursor >= End; }
+	const ANSICHAR* GetCursor() const { return Cursor; }
+	const ANSICHAR* GetEnd() const { return End; }
+
+	/** Skips spaces, tabs and line breaks */
+	void SkipWhitespace()
+	{
+		while (Cursor < End && IsWhitespace(*Cursor))
+		{
+			++Cursor;
+		}
+	}
+
+	/** Skips spaces and tabs, stopping at a line break */
+	void SkipBlanks()
+	{
+		while (Cursor < End && IsBlank(*Cursor))
+		{
+			++Cursor;
+		}
+	}
+
+	/** Moves the cursor past the next line break, scanning with memchr rather than a byte loop */
+	void SkipLine()
+	{
+		const void* Break = Cursor < End ? memchr(Cursor, '\n', End - Cursor) : nullptr;
+		Cursor = Break ? static_cast<const ANSICHAR*>(Break) + 1 : End;
+	}
+
+	/** Reads the next whitespace-delimited token, crossing line breaks */
+	bool NextToken(FAnsiStringView& OutToken)
+	{
+		SkipWhitespace();
+		return ReadToken(OutToken);
+	}
+
+	/** Reads the next token without leaving the current line */
+	bool NextTokenOnLine(FAnsiStringView& OutToken)
+	{
+		SkipBlanks();
+		return ReadToken(OutToken);
+	}
+
+	/** Reads the current line with surrounding blanks trimmed and moves past its line break */
+	bool ReadLine(FAnsiStringView& OutLine)
+	{
+		if (Cursor >= End)
+		{
+			return false;
+		}
+
+		SkipBlanks();
+		const ANSICHAR* LineStart = Cursor;
+		while (Cursor < End && *Cursor != '\n')
+		{
+			++Cursor;
+		}
+
+		const ANSICHAR* LineEnd = Cursor;
+		while (LineEnd > LineStart && IsWhitespace(LineEnd[-1]))
+		{
+			--LineEnd;
+		}
+		OutLine = FAnsiStringView(LineStart, UE_PTRDIFF_TO_INT32(LineEnd - LineStart));
+
+		if (Cursor < End)
+		{
+			++Cursor;
+		}
+		return true;
+	}
+
+	static bool IsBlank(ANSICHAR C)
+	{
+		return C == ' ' || C == '\t';
+	}
+
+	static bool IsWhitespace(ANSICHAR C)
+	{
+		return C == ' ' || C == '\t' || C == '\r' || C == '\n';
+	}
+
+	/** Case-sensitive comparison against a string literal */
+	template <int32 N>
+	static bool Matches(FAnsiStringView Token, const ANSICHAR (&Literal)[N])
+	{
+		return Token.Len() == N - 1 && FMemory::Memcmp(Token.GetData(), Literal, N - 1) == 0;
+	}
+
+	template <int32 N>
+	static bool StartsWith(FAnsiStringView Token, const ANSICHAR (&Literal)[N])
+	{
+		return Token.Len() >= N - 1 && FMemory::Memcmp(Token.GetData(), Literal, N - 1) == 0;
+	}
+
+	/** Parses a numeric token with the same result as FCString::Atod, without heap allocations */
+	static double ToDouble(FAnsiStringView Token)
+	{
+		double Value;
+		if (BVHFastFloat::TryParse(Token.GetData(), Token.GetData() + Token.Len(), Value))
+		{
+			return Value;
+		}
+		return ToDoubleAtod(Token);
+	}
+
+	/** ToDouble for untrusted input: fails unless the whole token is a decimal number, which Atod would silently read as 0 or a prefix */
+	static bool TryToDouble(FAnsiStringView Token, double& OutValue)
+	{
+		if (BVHFastFloat::TryParse(Token.GetData(), Token.GetData() + Token.Len(), OutValue))
+		{
+			return true;
+		}
+		if (!IsDecimalNumber(Token))
+		{
+			return false;
+		}
+		OutValue = ToDoubleAtod(Token);
+		return true;
+	}
+
+	/** Sign, digits with an optional point, and an optional exponent, with nothing left over */
+	static bool IsDecimalNumber(FAnsiStringView Token)
+	{
+		const auto IsDigit = [](ANSICHAR C) { return C >= '0' && C <= '9'; };
+		const ANSICHAR* Cursor = Token.GetData();
+		const ANSICHAR* const TokenEnd = Cursor + Token.Len();
+		if (Cursor < TokenEnd && (*Cursor == '-' || *Cursor == '+'))
+		{
+			++Cursor;
+		}
+
+		bool bAnyDigit = false;
+		for (; Cursor < TokenEnd && IsDigit(*Cursor); ++Cursor)
+		{
+			bAnyDigit = true;
+		}
+		if (Cursor < TokenEnd && *Cursor == '.')
+		{
+			for (++Cursor; Cursor < TokenEnd && IsDigit(*Cursor); ++Cursor)
+			{
+				bAnyDigit = true;
+			}
+		}
+		if (!bAnyDigit)
+		{
+			return false;
+		}
+
+		if (Cursor < TokenEnd && (*Cursor == 'e' || *Cursor == 'E'))
+		{
+			++Cursor;
+			if (Cursor < TokenEnd && (*Cursor == '-' || *Cursor == '+'))
+			{
+				++Cursor;
+			}
+			if (Cursor >= TokenEnd || !IsDigit(*Cursor))
+			{
+				return false;
+			}
+			while (Cursor < TokenEnd && IsDigit(*Cursor))
+			{
+				++Cursor;
+			}
+		}
+		return Cursor == TokenEnd;
+	}
+
+	/** Atod on a stack copy of the token, the fallback for anything the fast path does not handle */
+	static double ToDoubleAtod(FAnsiStringView Token)
+	{
+		ANSICHAR Buffer[128];
+		const int32 Len = FMath::Min(Token.Len(), (int32)UE_ARRAY_COUNT(Buffer) - 1);
+		FMemory::Memcpy(Buffer, Token.GetData(), Len);
+		Buffer[Len] = '\0';
+		return FCStringAnsi::Atod(Buffer);
+	}
+
+	static int32 ToInt(FAnsiStringView Token)
+	{
+		ANSICHAR Buffer[32];
+		const int32 Len = FMath::Min(Token.Len(), (int32)UE_ARRAY_COUNT(Buffer) - 1);
+		FMemory::Memcpy(Buffer, Token.GetData(), Len);
+		Buffer[Len] = '\0';
+		return FCStringAnsi::Atoi(Buffer);
+	}
+
+private:
+	bool ReadToken(FAnsiStringView& OutToken)
+	{
+		const ANSICHAR* TokenStart = Cursor;
+		while (Cursor < End && !IsWhitespace(*Cursor))
+		{
+			++Cursor;
+		}
+		OutToken = FAnsiStringView(TokenStart, UE_PTRDIFF_TO_INT32(Cursor - TokenStart));
+		return Cursor > TokenStart;
+	}
+
+	const ANSICHAR* Cursor;
+	const ANSICHAR* End;
+};
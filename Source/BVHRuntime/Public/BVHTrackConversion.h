@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BVHParser.h"
+
+// Convert BVH (Y-Up, Right-Handed) to UE (Z-Up, Left-Handed)
+// Mapping: UE_X = BVH_X, UE_Y = -BVH_Z, UE_Z = BVH_Y
+inline FVector ConvertPos(const FVector3d& InPos)
+{
+	return FVector(InPos.X, -InPos.Z, InPos.Y);
+}
+
+inline FQuat ConvertRot(const FQuat& InRot)
+{
+	// Convert quaternion from BVH space to UE space
+	return FQuat(InRot.X, -InRot.Z, InRot.Y, InRot.W);
+}
+
+namespace BVHTrackConversion
+{
+	/**
+	 * Composes a bone's rotation channels into UE-space quaternions, four frames per iteration.
+	 * RotationAxes holds the rotation channels in file order and AngleTracks the matching
+	 * contiguous per-frame angles in degrees, as produced by the channel-major layout.
+	 */
+	BVHRUNTIME_API void EulerToQuatBatch(TConstArrayView<EBVHChannel> RotationAxes, TConstArrayView<const double*> AngleTracks, int32 NumFrames, FQuat* OutRotations);
+
+	/** Scalar reference of EulerToQuatBatch, one FQuat per channel and frame */
+	BVHRUNTIME_API void EulerToQuatScalar(TConstArrayView<EBVHChannel> RotationAxes, TConstArrayView<const double*> AngleTracks, int32 NumFrames, FQuat* OutRotations);
+
+	/**
+	 * Sample a node's channels into UE-space keys. NodeTracks holds one contiguous track per node channel,
+	 * in channel order. Dispatch happens once per call on the layout resolved at parse time, the per-frame
+	 * loops are specialized per rotation order and carry no channel branches.
+	 */
+	BVHRUNTIME_API void SamplePositions(const FBVHNode& Node, TConstArrayView<const double*> NodeTracks, int32 NumFrames, FVector* OutPositions);
+	BVHRUNTIME_API void SampleRotations(const FBVHNode& Node, TConstArrayView<const double*> NodeTracks, int32 NumFrames, FQuat* OutRotations);
+}
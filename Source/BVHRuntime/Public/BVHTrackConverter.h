@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BVHParser.h"
+
+/** Local bone transforms of one evaluated frame, sized once by FBVHTrackConverter::InitPose */
+struct FBVHPoseBuffer
+{
+	TArray<FTransform> LocalTransforms; // One per FBVHData::Nodes entry, in UE space
+
+private:
+	friend class FBVHTrackConverter;
+
+	// One per channel, pointing at the frame being evaluated
+	TArray<const double*> ChannelValues;
+};
+
+/**
+ * Converts BVH motion into UE-space bone transforms, independent of any animation asset.
+ * EvaluatePose reuses the buffers InitPose sized, so evaluating a frame never allocates. The
+ * converter itself is immutable after Initialize and can be shared by threads that each own a
+ * pose buffer. Custom channel layouts with more than three rotation channels are the one case
+ * that still allocates.
+ */
+class BVHRUNTIME_API FBVHTrackConverter
+{
+public:
+	/** Copies the hierarchy and its channel layout, the motion data is not retained */
+	void Initialize(const FBVHData& Data);
+
+	int32 GetNumBones() const { return Nodes.Num(); }
+	int32 GetNumChannels() const { return NumChannels; }
+	TConstArrayView<FBVHNode> GetNodes() const { return Nodes; }
+
+	/** Sizes a pose buffer for this hierarchy, the only allocation of the runtime path */
+	void InitPose(FBVHPoseBuffer& OutPose) const;
+
+	/** Evaluates one frame of NumChannels values in channel order, like a FrameMajor row or a streamed frame */
+	void EvaluatePose(TConstArrayView<double> FrameValues, FBVHPoseBuffer& Pose) const;
+
+	/** Evaluates a frame of a parsed take in either motion layout */
+	void EvaluatePose(const FBVHData& Data, int32 FrameIndex, FBVHPoseBuffer& Pose) const;
+
+	/**
+	 * Converts all frames of a chunk for one node in a single batch. OutPositions and OutRotations
+	 * receive Chunk.NumFrames keys each.
+	 */
+	static void ConvertNodeChunk(const FBVHNode& Node, const FBVHMotionChunk& Chunk, FVector* OutPositions, FQuat* OutRotations);
+
+private:
+	void EvaluateChannels(const double* FirstValue, int64 ChannelStride, FBVHPoseBuffer& Pose) const;
+
+	TArray<FBVHNode> Nodes;
+	int32 NumChannels = 0;
+};